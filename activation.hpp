@@ -1,5 +1,6 @@
 #pragma once
 #include <cmath>
+#include <functional>
 #include <string>
 
 namespace activation {
@@ -61,4 +62,17 @@ inline Type fromString(const std::string& input) {
     return Type::SIGMOID;
 }
 
+/* Activation function for a type, for code that runs layers outside of
+   NeuralNet (e.g. on weights living in shared memory). */
+template<typename T>
+inline std::function<T(T)> function(Type type) {
+    switch (type) {
+        case Type::TANH:       return tanh_fn<T>;
+        case Type::RELU:       return relu<T>;
+        case Type::LEAKY_RELU: return leaky_relu<T>;
+        case Type::SIGMOID:
+        default:               return sigmoid<T>;
+    }
+}
+
 }  // namespace activation
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <limits>
+
+/* Minimal std::allocator replacement that hands out memory aligned to
+   Alignment bytes (64 by default, one cache line / one AVX-512 register).
+   Used as the storage allocator for Matrix<T> so SIMD loads never split
+   cache lines and packed GEMM buffers can be addressed without fix-ups. */
+template<typename T, std::size_t Alignment = 64>
+class AlignedAllocator {
+public:
+  static_assert(Alignment >= alignof(T), "Alignment must be at least alignof(T)");
+  static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+  using value_type = T;
+
+  template<typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    if (n == 0) {
+      return nullptr;
+    }
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  void deallocate(T* p, std::size_t /*n*/) noexcept {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+
+  template<typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+
+  template<typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
@@ -0,0 +1,139 @@
+/* Memory/compute trade-off of gradient checkpointing.
+
+   For each checkpoint interval k, trains a deep MLP on random batches in a
+   fresh child process and reports the median step time, the activation bytes
+   alive at the peak of a step (NeuralNet::lastTrainStats) and the process'
+   peak resident set size. k = 1 is the baseline that stores every layer.
+
+   Usage: checkpoint_bench [--depth L] [--width W] [--batch B] [--steps S]
+                           [--intervals 1,2,4,8] */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "neuralnetwork.hpp"
+
+namespace {
+
+struct Options {
+  int depth = 16;
+  int width = 256;
+  int batch = 64;
+  int steps = 5;
+  std::vector<int> intervals = {1, 2, 4, 8};
+};
+
+struct Result {
+  double step_ms;
+  double activation_mb;
+  double max_rss_mb;
+  int ok;
+};
+
+Options parseArgs(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    std::string value = argv[i + 1];
+    if (flag == "--depth") options.depth = std::stoi(value);
+    else if (flag == "--width") options.width = std::stoi(value);
+    else if (flag == "--batch") options.batch = std::stoi(value);
+    else if (flag == "--steps") options.steps = std::stoi(value);
+    else if (flag == "--intervals") {
+      options.intervals.clear();
+      std::stringstream ss(value);
+      std::string item;
+      while (std::getline(ss, item, ',')) options.intervals.push_back(std::stoi(item));
+    } else {
+      throw std::runtime_error("Unknown flag: " + flag);
+    }
+  }
+  return options;
+}
+
+Result measure(const Options& options, int interval) {
+  std::vector<int> layers(options.depth + 1, options.width);
+  NeuralNet<float> net;
+  net.setLayerSizes(layers);
+  net.setActivation("Tanh");
+  net.setSeed(7);
+  net.build();
+  net.setCheckpointInterval(interval);
+
+  Matrix<float> input(options.width, options.batch);
+  Matrix<float> target(options.width, options.batch);
+  input.fillRandom(-1.0f, 1.0f, rng::Stream{1, 0});
+  target.fillRandom(-1.0f, 1.0f, rng::Stream{1, 1});
+
+  std::vector<double> times;
+  std::size_t peak_activation = 0;
+  for (int s = 0; s < options.steps; ++s) {
+    auto start = std::chrono::steady_clock::now();
+    net.train(input, target, 0.01f);
+    times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    peak_activation = std::max(peak_activation, net.lastTrainStats().peak_activation_bytes);
+  }
+  std::sort(times.begin(), times.end());
+
+  rusage usage{};
+  ::getrusage(RUSAGE_SELF, &usage);
+
+  return Result{times[times.size() / 2], peak_activation / (1024.0 * 1024.0),
+                usage.ru_maxrss / 1024.0, 1};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = parseArgs(argc, argv);
+
+  /* Results come back through an anonymous shared mapping; every interval
+     runs in its own process so peak RSS is not inherited between runs. */
+  void* shared = ::mmap(nullptr, sizeof(Result), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    std::cerr << "mmap() failed\n";
+    return 1;
+  }
+  Result* result = static_cast<Result*>(shared);
+
+  std::cout << "depth " << options.depth << ", width " << options.width << ", batch " << options.batch
+            << ", " << options.steps << " steps per interval\n\n";
+  std::cout << std::setw(6) << "k" << std::setw(14) << "step (ms)" << std::setw(18) << "activations (MB)"
+            << std::setw(16) << "peak RSS (MB)" << std::setw(12) << "vs k=1" << "\n";
+
+  double baseline_ms = 0.0;
+  for (int interval : options.intervals) {
+    *result = Result{0, 0, 0, 0};
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      std::cout.setstate(std::ios::failbit);  // silence build() output in the child
+      *result = measure(options, interval);
+      std::_Exit(0);
+    }
+    ::waitpid(pid, nullptr, 0);
+    if (!result->ok) {
+      std::cerr << "Run with k=" << interval << " failed\n";
+      return 1;
+    }
+    if (baseline_ms == 0.0) baseline_ms = result->step_ms;
+
+    std::cout << std::setw(6) << interval << std::setw(14) << std::fixed << std::setprecision(2) << result->step_ms
+              << std::setw(18) << result->activation_mb << std::setw(16) << result->max_rss_mb
+              << std::setw(11) << result->step_ms / baseline_ms << "x\n";
+  }
+
+  ::munmap(shared, sizeof(Result));
+  return 0;
+}
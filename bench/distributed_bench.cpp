@@ -0,0 +1,292 @@
+/* Throughput and convergence of distributed data-parallel training.
+
+   A fixed random "teacher" network labels synthetic inputs with one of C
+   classes; a student MLP learns them with distributed::Trainer. For every
+   topology x compression x process count, the bench forks the workers (and
+   the parameter server), each worker trains on its own shard with batch B
+   for S steps, and the table reports global samples/s, wire bytes per
+   worker step, the share of time spent communicating, and the held-out
+   loss and accuracy of the final model. Every configuration starts from
+   the same weights and sees the same samples per step and worker.
+
+   Usage: distributed_bench [--procs 1,2,4,8] [--topology ps,ring]
+                            [--compression none,fp16,topk] [--transport unix|tcp]
+                            [--steps S] [--batch B] [--hidden H] [--lr LR]
+                            [--top-k RATIO] */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "distributed.hpp"
+#include "neuralnetwork.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kFeatures = 32;
+constexpr int kClasses = 8;
+constexpr int kTrainSamples = 16384;
+constexpr int kEvalSamples = 2048;
+
+struct Options {
+  std::vector<int> procs = {1, 2, 4, 8};
+  std::vector<std::string> topologies = {"ps", "ring"};
+  std::vector<std::string> compressions = {"none", "fp16", "topk"};
+  std::string transport = "unix";
+  int steps = 300;
+  int batch = 32;
+  int hidden = 128;
+  float learning_rate = 1.0f;
+  double top_k_ratio = 0.1;
+};
+
+/* One slot per worker, written by the child through a shared mapping. */
+struct WorkerResult {
+  double seconds;
+  double communicate_seconds;
+  double bytes_per_step;
+  double loss;      // rank 0 only
+  double accuracy;  // rank 0 only
+  int ok;
+};
+
+std::vector<std::string> splitList(const std::string& value) {
+  std::vector<std::string> items;
+  std::stringstream ss(value);
+  std::string item;
+  while (std::getline(ss, item, ',')) items.push_back(item);
+  return items;
+}
+
+Options parseArgs(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    std::string value = argv[i + 1];
+    if (flag == "--procs") {
+      options.procs.clear();
+      for (const std::string& item : splitList(value)) options.procs.push_back(std::stoi(item));
+    } else if (flag == "--topology") options.topologies = splitList(value);
+    else if (flag == "--compression") options.compressions = splitList(value);
+    else if (flag == "--transport") options.transport = value;
+    else if (flag == "--steps") options.steps = std::stoi(value);
+    else if (flag == "--batch") options.batch = std::stoi(value);
+    else if (flag == "--hidden") options.hidden = std::stoi(value);
+    else if (flag == "--lr") options.learning_rate = std::stof(value);
+    else if (flag == "--top-k") options.top_k_ratio = std::stod(value);
+    else throw std::runtime_error("Unknown flag: " + flag);
+  }
+  if (options.transport != "unix" && options.transport != "tcp") {
+    throw std::runtime_error("--transport must be unix or tcp");
+  }
+  return options;
+}
+
+struct Dataset {
+  Matrix<float> input;   // features x samples
+  Matrix<float> target;  // classes x samples, one-hot
+};
+
+Dataset makeDataset(const NeuralNet<float>& teacher, int samples, uint64_t stream) {
+  Dataset data{Matrix<float>(kFeatures, samples), Matrix<float>(kClasses, samples)};
+  data.input.fillRandom(-1.0f, 1.0f, rng::Stream{2024, stream});
+  Matrix<float> scores = teacher.predict(data.input);
+  for (int j = 0; j < samples; ++j) {
+    int best = 0;
+    for (int c = 1; c < kClasses; ++c) {
+      if (scores.get(c, j) > scores.get(best, j)) best = c;
+    }
+    for (int c = 0; c < kClasses; ++c) data.target.set(c, j, c == best ? 1.0f : 0.0f);
+  }
+  return data;
+}
+
+NeuralNet<float> makeStudent(const Options& options) {
+  NeuralNet<float> net;
+  net.setLayerSizes({kFeatures, options.hidden, kClasses});
+  net.setActivation("Sigmoid");
+  net.setSeed(7);
+  net.build();
+  return net;
+}
+
+void evaluate(const NeuralNet<float>& net, const Dataset& eval, WorkerResult& result) {
+  Matrix<float> output = net.predict(eval.input);
+  double loss = 0.0;
+  int correct = 0;
+  for (int j = 0; j < output.cols(); ++j) {
+    int best = 0;
+    for (int c = 0; c < kClasses; ++c) {
+      double diff = output.get(c, j) - eval.target.get(c, j);
+      loss += diff * diff;
+      if (output.get(c, j) > output.get(best, j)) best = c;
+    }
+    if (eval.target.get(best, j) == 1.0f) ++correct;
+  }
+  result.loss = loss / output.cols();
+  result.accuracy = static_cast<double>(correct) / output.cols();
+}
+
+/* Worker `rank` reads batch s from its shard: samples
+   ((s * world + rank) * B + j) mod N. */
+void runWorker(const Options& options, const distributed::Options& dist, const Dataset& train,
+               const Dataset& eval, WorkerResult& result) {
+  NeuralNet<float> net = makeStudent(options);
+  distributed::Trainer trainer(net, dist);
+
+  Matrix<float> input(kFeatures, options.batch);
+  Matrix<float> target(kClasses, options.batch);
+  auto start = Clock::now();
+  for (int s = 0; s < options.steps; ++s) {
+    for (int j = 0; j < options.batch; ++j) {
+      int sample = static_cast<int>(
+          ((static_cast<long>(s) * dist.world_size + dist.rank) * options.batch + j) % kTrainSamples);
+      for (int i = 0; i < kFeatures; ++i) input.set(i, j, train.input.get(i, sample));
+      for (int c = 0; c < kClasses; ++c) target.set(c, j, train.target.get(c, sample));
+    }
+    trainer.step(input, target, options.learning_rate);
+  }
+  result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  const distributed::Stats& stats = trainer.stats();
+  result.communicate_seconds = stats.communicate_seconds;
+  result.bytes_per_step = static_cast<double>(stats.bytes_sent + stats.bytes_received) / options.steps;
+  if (dist.rank == 0) evaluate(net, eval, result);
+  result.ok = 1;
+}
+
+std::string makeEndpoint(const Options& options, int run) {
+  if (options.transport == "tcp") {
+    /* A fresh port range per run so lingering TIME_WAIT sockets never collide. */
+    int base = 20000 + static_cast<int>(::getpid() % 500) * 64 + (run % 4) * 16;
+    return "tcp:127.0.0.1:" + std::to_string(base);
+  }
+  return "unix:/tmp/nn_dist_bench." + std::to_string(::getpid()) + "." + std::to_string(run);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = parseArgs(argc, argv);
+  std::cout.setstate(std::ios::failbit);  // silence build() output
+
+  NeuralNet<float> teacher;
+  teacher.setLayerSizes({kFeatures, 32, kClasses});
+  teacher.setActivation("Tanh");
+  teacher.setSeed(99);
+  teacher.build();
+  const Dataset train = makeDataset(teacher, kTrainSamples, 0);
+  const Dataset eval = makeDataset(teacher, kEvalSamples, 1);
+
+  const int max_procs = *std::max_element(options.procs.begin(), options.procs.end());
+  const std::size_t shared_bytes = max_procs * sizeof(WorkerResult);
+  void* shared = ::mmap(nullptr, shared_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    std::cerr << "mmap() failed\n";
+    return 1;
+  }
+  WorkerResult* results = static_cast<WorkerResult*>(shared);
+
+  std::cout.clear();
+  std::cout << "student " << kFeatures << "-" << options.hidden << "-" << kClasses << " (Sigmoid), batch "
+            << options.batch << " per worker, " << options.steps << " steps, " << options.transport
+            << " sockets, top-k ratio " << options.top_k_ratio << "\n\n";
+  std::cout << std::left << std::setw(6) << "topo" << std::setw(7) << "codec" << std::right << std::setw(6)
+            << "procs" << std::setw(14) << "samples/s" << std::setw(14) << "KB/step" << std::setw(9) << "comm %"
+            << std::setw(10) << "loss" << std::setw(10) << "accuracy" << "\n";
+
+  int run = 0;
+  for (const std::string& topology : options.topologies) {
+    for (const std::string& compression : options.compressions) {
+      for (int procs : options.procs) {
+        distributed::Options dist;
+        dist.topology = distributed::topologyFromString(topology);
+        dist.compression = distributed::compressionFromString(compression);
+        dist.top_k_ratio = options.top_k_ratio;
+        dist.endpoint = makeEndpoint(options, run++);
+        dist.world_size = procs;
+
+        std::fill(results, results + procs, WorkerResult{0, 0, 0, 0, 0, 0});
+        std::vector<pid_t> children;
+
+        if (dist.topology == distributed::Topology::PARAMETER_SERVER) {
+          pid_t pid = ::fork();
+          if (pid == 0) {
+            std::cout.setstate(std::ios::failbit);
+            try {
+              NeuralNet<float> master = makeStudent(options);
+              distributed::ParameterServer server(master, dist);
+              server.run();
+            } catch (const std::exception& e) {
+              std::cerr << "server: " << e.what() << "\n";
+              std::_Exit(1);
+            }
+            std::_Exit(0);
+          }
+          children.push_back(pid);
+        }
+
+        for (int rank = 0; rank < procs; ++rank) {
+          pid_t pid = ::fork();
+          if (pid == 0) {
+            std::cout.setstate(std::ios::failbit);
+            dist.rank = rank;
+            try {
+              runWorker(options, dist, train, eval, results[rank]);
+            } catch (const std::exception& e) {
+              std::cerr << "worker " << rank << ": " << e.what() << "\n";
+              std::_Exit(1);
+            }
+            std::_Exit(0);
+          }
+          children.push_back(pid);
+        }
+
+        bool ok = true;
+        for (pid_t pid : children) {
+          int status = 0;
+          ::waitpid(pid, &status, 0);
+          ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        }
+        double seconds = 0.0;
+        double communicate = 0.0;
+        double bytes = 0.0;
+        for (int rank = 0; rank < procs; ++rank) {
+          ok = ok && results[rank].ok;
+          seconds = std::max(seconds, results[rank].seconds);
+          communicate += results[rank].communicate_seconds / results[rank].seconds;
+          bytes += results[rank].bytes_per_step;
+        }
+        if (!ok) {
+          std::cerr << topology << "/" << compression << " with " << procs << " processes failed\n";
+          ::munmap(shared, shared_bytes);
+          return 1;
+        }
+
+        double samples = static_cast<double>(procs) * options.batch * options.steps;
+        std::cout << std::left << std::setw(6) << topology << std::setw(7) << compression << std::right
+                  << std::setw(6) << procs << std::fixed << std::setprecision(0) << std::setw(14)
+                  << samples / seconds << std::setprecision(1) << std::setw(14) << bytes / procs / 1024.0
+                  << std::setw(8) << 100.0 * communicate / procs << "%" << std::setprecision(4)
+                  << std::setw(10) << results[0].loss << std::setprecision(3) << std::setw(10)
+                  << results[0].accuracy << "\n";
+      }
+    }
+  }
+
+  ::munmap(shared, shared_bytes);
+  return 0;
+}
@@ -0,0 +1,144 @@
+/* Ensemble engine vs. calling predict() on every member.
+
+   Trains nothing: members are seeded builds of the same topology, which is
+   all the engine cares about. For each ensemble size it checks that the
+   mean and vote reductions match a per-member loop, then reports samples/s
+   of both paths and the speedup.
+
+   Usage: ensemble_bench [--layers 4,16,16,3] [--members 8,16,32] [--batch B]
+                         [--iters N] [--threads T] [--activation Sigmoid] */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ensemble.hpp"
+#include "neuralnetwork.hpp"
+
+namespace {
+
+struct Options {
+  std::vector<int> layers = {4, 16, 16, 3};
+  std::vector<int> members = {8, 16, 32};
+  int batch = 1;
+  int iters = 2000;
+  int threads = 1;
+  std::string activation = "Sigmoid";
+};
+
+std::vector<int> parseList(const std::string& value) {
+  std::vector<int> items;
+  std::stringstream ss(value);
+  std::string item;
+  while (std::getline(ss, item, ',')) items.push_back(std::stoi(item));
+  return items;
+}
+
+Options parseArgs(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    std::string value = argv[i + 1];
+    if (flag == "--layers") options.layers = parseList(value);
+    else if (flag == "--members") options.members = parseList(value);
+    else if (flag == "--batch") options.batch = std::stoi(value);
+    else if (flag == "--iters") options.iters = std::stoi(value);
+    else if (flag == "--threads") options.threads = std::stoi(value);
+    else if (flag == "--activation") options.activation = value;
+    else throw std::runtime_error("Unknown flag: " + flag);
+  }
+  return options;
+}
+
+/* What callers did before the engine: one predict() per member. */
+Matrix<float> loopMean(const std::vector<NeuralNet<float>>& members, MatrixView<const float> input) {
+  Matrix<float> sum = members[0].predict(input);
+  for (std::size_t m = 1; m < members.size(); ++m) {
+    sum.add(members[m].predict(input));
+  }
+  const float scale = 1.0f / members.size();
+  sum.apply([scale](float x) { return x * scale; });
+  return sum;
+}
+
+Matrix<float> loopVote(const std::vector<NeuralNet<float>>& members, MatrixView<const float> input) {
+  Matrix<float> votes(members[0].layerSizes().back(), input.cols());
+  votes.fill(0.0f);
+  for (const NeuralNet<float>& member : members) {
+    Matrix<float> out = member.predict(input);
+    for (int j = 0; j < out.cols(); ++j) {
+      int best = 0;
+      for (int c = 1; c < out.rows(); ++c) {
+        if (out.get(c, j) > out.get(best, j)) best = c;
+      }
+      votes.set(best, j, votes.get(best, j) + 1.0f / members.size());
+    }
+  }
+  return votes;
+}
+
+float maxDifference(const Matrix<float>& a, const Matrix<float>& b) {
+  float diff = 0.0f;
+  for (int r = 0; r < a.rows(); ++r) {
+    for (int c = 0; c < a.cols(); ++c) {
+      diff = std::max(diff, std::fabs(a.get(r, c) - b.get(r, c)));
+    }
+  }
+  return diff;
+}
+
+template<typename Fn>
+double samplesPerSecond(int iters, int batch, Fn&& fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iters; ++i) fn();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return static_cast<double>(iters) * batch / seconds;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = parseArgs(argc, argv);
+
+  Matrix<float> input(options.layers.front(), options.batch);
+  input.fillRandom(-1.0f, 1.0f, rng::Stream{5, 0});
+
+  std::cout << "layers";
+  for (int size : options.layers) std::cout << " " << size;
+  std::cout << ", " << options.activation << ", batch " << options.batch << ", " << options.threads
+            << " thread(s)\n\n";
+  std::cout << std::setw(8) << "members" << std::setw(18) << "loop (samples/s)" << std::setw(22)
+            << "ensemble (samples/s)" << std::setw(10) << "speedup" << "\n";
+
+  for (int count : options.members) {
+    std::vector<NeuralNet<float>> members(count);
+    std::cout.setstate(std::ios::failbit);  // silence build()
+    for (int m = 0; m < count; ++m) {
+      members[m].setLayerSizes(options.layers);
+      members[m].setActivation(options.activation);
+      members[m].setSeed(100 + m);
+      members[m].build();
+    }
+    std::cout.clear();
+
+    Ensemble<float> ensemble(members, options.threads);
+    using Reduction = Ensemble<float>::Reduction;
+    if (maxDifference(ensemble.predict(input, Reduction::MEAN), loopMean(members, input)) != 0.0f ||
+        maxDifference(ensemble.predict(input, Reduction::VOTE), loopVote(members, input)) != 0.0f) {
+      std::cerr << count << " members: ensemble output differs from the per-member loop\n";
+      return 1;
+    }
+
+    double loop = samplesPerSecond(options.iters, options.batch, [&] { loopMean(members, input); });
+    double fused = samplesPerSecond(options.iters, options.batch, [&] { ensemble.predict(input); });
+    std::cout << std::setw(8) << count << std::fixed << std::setprecision(0) << std::setw(18) << loop
+              << std::setw(22) << fused << std::setprecision(2) << std::setw(9) << fused / loop << "x\n";
+  }
+  return 0;
+}
@@ -0,0 +1,248 @@
+/* Load generator for the shared-memory inference daemon.
+
+   Starts an InferenceServer in a child process, forks N client processes that
+   each issue R predict requests through their shared-memory slot, and reports
+   end-to-end latency next to the cost of the same predict() run in-process.
+   The difference is the per-request overhead of the daemon (socket round
+   trip, scheduling, slot handling); the exit status is non-zero when its
+   median exceeds --budget-us. The budget assumes every client has a core
+   to itself, so --clients defaults to min(4, cores): with more clients than
+   cores the median measures time waiting for a CPU, not the daemon.
+
+   Usage: inference_bench [--clients N] [--requests R] [--batch B]
+                          [--budget-us U] [--model path.bin] */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "inference_client.hpp"
+#include "inference_server.hpp"
+#include "neuralnetwork.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  int clients = std::min(4, static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)));
+  int requests = 20000;
+  int batch = 1;
+  double budget_us = 50.0;
+  std::string model;
+};
+
+Options parseArgs(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    const char* value = argv[i + 1];
+    if (flag == "--clients") options.clients = std::atoi(value);
+    else if (flag == "--requests") options.requests = std::atoi(value);
+    else if (flag == "--batch") options.batch = std::atoi(value);
+    else if (flag == "--budget-us") options.budget_us = std::atof(value);
+    else if (flag == "--model") options.model = value;
+    else throw std::runtime_error("Unknown flag: " + flag);
+  }
+  return options;
+}
+
+double percentile(std::vector<double> values, double p) {
+  std::sort(values.begin(), values.end());
+  std::size_t index = static_cast<std::size_t>(p * (values.size() - 1));
+  return values[index];
+}
+
+InferenceServer* server_instance = nullptr;
+
+void stopServer(int /*signal*/) {
+  if (server_instance) server_instance->stop();
+}
+
+pid_t startServer(const std::string& model, const std::string& socket_path, const Options& options) {
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    int status = 0;
+    try {
+      InferenceServerOptions server_options;
+      server_options.max_clients = options.clients + 2;  // + probe and check clients
+      server_options.max_batch = options.batch;
+      InferenceServer server(model, socket_path, server_options);
+      server_instance = &server;
+      std::signal(SIGTERM, stopServer);
+      server.run();
+      server_instance = nullptr;
+    } catch (const std::exception& e) {
+      std::cerr << "Server failed: " << e.what() << "\n";
+      status = 1;
+    }
+    std::_Exit(status);
+  }
+  return pid;
+}
+
+/* The server process creates the socket once it has loaded the model. */
+void waitForServer(const std::string& socket_path) {
+  for (int attempt = 0; attempt < 500; ++attempt) {
+    try {
+      InferenceClient probe(socket_path);
+      return;
+    } catch (const std::exception&) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  throw std::runtime_error("Inference server did not come up.");
+}
+
+void runClient(const std::string& socket_path, const Options& options, double* latencies_us) {
+  InferenceClient client(socket_path);
+  MatrixView<float> input = client.input(options.batch);
+  for (int r = 0; r < input.rows(); ++r) {
+    for (int c = 0; c < input.cols(); ++c) {
+      input(r, c) = std::sin(0.1f * (r + 1) * (c + 1));
+    }
+  }
+
+  for (int i = 0; i < options.requests / 10; ++i) {
+    client.predict(options.batch);
+  }
+  for (int i = 0; i < options.requests; ++i) {
+    auto start = Clock::now();
+    client.predict(options.batch);
+    latencies_us[i] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = parseArgs(argc, argv);
+  std::string tag = std::to_string(::getpid());
+  std::string socket_path = "/tmp/nncpp-bench-" + tag + ".sock";
+
+  bool temporary_model = options.model.empty();
+  if (temporary_model) {
+    options.model = "/tmp/nncpp-bench-" + tag + ".bin";
+    NeuralNet<float> net;
+    net.setLayerSizes({64, 128, 128, 10});
+    net.setActivation("ReLU");
+    net.setSeed(1);
+    net.build();
+    net.save(options.model);
+  }
+
+  /* In-process reference: same model, same batch, no daemon in between. */
+  NeuralNet<float> local;
+  local.load(options.model);
+  Matrix<float> sample(local.layerSizes().front(), options.batch);
+  for (int r = 0; r < sample.rows(); ++r) {
+    for (int c = 0; c < sample.cols(); ++c) {
+      sample.set(r, c, std::sin(0.1f * (r + 1) * (c + 1)));
+    }
+  }
+  std::vector<double> local_us(options.requests);
+  for (int i = 0; i < options.requests; ++i) {
+    auto start = Clock::now();
+    Matrix<float> out = local.predict(sample);
+    local_us[i] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  }
+
+  pid_t server = startServer(options.model, socket_path, options);
+  int exit_code = 0;
+  try {
+    waitForServer(socket_path);
+
+    /* The daemon must return exactly what predict() computes locally. */
+    {
+      InferenceClient check(socket_path);
+      Matrix<float> expected = local.predict(sample);
+      Matrix<float> actual = check.predict(sample);
+      for (int i = 0; i < expected.rows() * expected.cols(); ++i) {
+        if (expected.get(i) != actual.get(i)) {
+          throw std::runtime_error("Daemon output differs from local predict().");
+        }
+      }
+    }
+
+    std::size_t total = static_cast<std::size_t>(options.clients) * options.requests;
+    void* shared = ::mmap(nullptr, total * sizeof(double), PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+      throw std::runtime_error("mmap() for results failed");
+    }
+    double* latencies = static_cast<double*>(shared);
+
+    auto start = Clock::now();
+    std::vector<pid_t> clients;
+    for (int c = 0; c < options.clients; ++c) {
+      pid_t pid = ::fork();
+      if (pid == 0) {
+        int status = 0;
+        try {
+          runClient(socket_path, options, latencies + static_cast<std::size_t>(c) * options.requests);
+        } catch (const std::exception& e) {
+          std::cerr << "Client failed: " << e.what() << "\n";
+          status = 1;
+        }
+        std::_Exit(status);
+      }
+      clients.push_back(pid);
+    }
+    for (pid_t pid : clients) {
+      int status = 0;
+      ::waitpid(pid, &status, 0);
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("A client process failed.");
+      }
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> e2e(latencies, latencies + total);
+    ::munmap(shared, total * sizeof(double));
+
+    double local_p50 = percentile(local_us, 0.5);
+    double e2e_p50 = percentile(e2e, 0.5);
+    double e2e_p99 = percentile(e2e, 0.99);
+    double overhead_p50 = e2e_p50 - local_p50;
+    double overhead_p99 = e2e_p99 - percentile(local_us, 0.99);
+
+    std::cout << "clients: " << options.clients << ", requests/client: " << options.requests
+              << ", batch: " << options.batch << "\n";
+    std::cout << "local predict      p50 " << local_p50 << " us\n";
+    std::cout << "daemon round trip  p50 " << e2e_p50 << " us, p99 " << e2e_p99 << " us\n";
+    std::cout << "overhead           p50 " << overhead_p50 << " us, p99 " << overhead_p99
+              << " us (budget " << options.budget_us << " us)\n";
+    std::cout << "throughput         " << total / wall << " requests/s, "
+              << total * options.batch / wall << " samples/s\n";
+
+    if (overhead_p50 > options.budget_us) {
+      std::cout << "FAIL: median overhead exceeds budget\n";
+      exit_code = 1;
+    } else {
+      std::cout << "PASS\n";
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    exit_code = 1;
+  }
+
+  ::kill(server, SIGTERM);
+  ::waitpid(server, nullptr, 0);
+  if (temporary_model) {
+    std::remove(options.model.c_str());
+  }
+  return exit_code;
+}
@@ -0,0 +1,154 @@
+/* Local vs remote vs interleaved vs replicated weight placement.
+
+   Builds one large MLP and runs numa::Executor over it with each placement.
+   Rows come in two groups that each share one worker set, so rows within a
+   group differ only in where the weights live:
+   - workers of --worker-node: "local" (the single copy on that node) and
+     "remote" (on another node);
+   - workers of every node: "single" (one copy on --worker-node),
+     "interleave" and "replicate".
+   On a single-node machine both sets are the same node, "remote" is skipped
+   and "single" would repeat "local". Each output is checked against
+   NeuralNet::predict before timing.
+
+   Usage: numa_bench [--layers 1024,2048,2048,1024] [--batch B] [--iters N]
+                     [--worker-node ID] */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "neuralnetwork.hpp"
+#include "numa_inference.hpp"
+
+namespace {
+
+struct Options {
+  std::vector<int> layers = {1024, 2048, 2048, 1024};
+  int batch = 64;
+  int iters = 20;
+  int worker_node = -1;  // -1: the first detected node
+};
+
+struct Config {
+  std::string name;
+  numa::Options executor;
+};
+
+Options parseArgs(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    std::string value = argv[i + 1];
+    if (flag == "--batch") options.batch = std::stoi(value);
+    else if (flag == "--iters") options.iters = std::stoi(value);
+    else if (flag == "--worker-node") options.worker_node = std::stoi(value);
+    else if (flag == "--layers") {
+      options.layers.clear();
+      std::stringstream ss(value);
+      std::string item;
+      while (std::getline(ss, item, ',')) options.layers.push_back(std::stoi(item));
+    } else {
+      throw std::runtime_error("Unknown flag: " + flag);
+    }
+  }
+  return options;
+}
+
+std::string describePages(const std::vector<numa::Executor<float>::CopyPlacement>& copies) {
+  std::ostringstream out;
+  for (const auto& copy : copies) {
+    out << (copy.node < 0 ? std::string("il") : "n" + std::to_string(copy.node)) << ":[";
+    if (copy.pages_per_node.empty()) out << "n/a";
+    for (std::size_t node = 0; node < copy.pages_per_node.size(); ++node) {
+      out << (node ? " " : "") << copy.pages_per_node[node];
+    }
+    out << "] ";
+  }
+  return out.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = parseArgs(argc, argv);
+  numa::Topology topology = numa::Topology::detect();
+  std::cout << "topology: " << topology.describe() << "\n";
+
+  int local = options.worker_node >= 0 ? options.worker_node : topology.nodes.front().id;
+  int remote = -1;
+  for (const numa::Node& node : topology.nodes) {
+    if (node.id != local) {
+      remote = node.id;
+      break;
+    }
+  }
+
+  NeuralNet<float> net;
+  net.setLayerSizes(options.layers);
+  net.setActivation("Tanh");
+  net.setSeed(11);
+  std::cout.setstate(std::ios::failbit);  // silence build()
+  net.build();
+  std::cout.clear();
+
+  Matrix<float> input(options.layers.front(), options.batch);
+  input.fillRandom(-1.0f, 1.0f, rng::Stream{3, 0});
+  Matrix<float> expected = net.predict(input);
+
+  std::vector<Config> configs;
+  configs.push_back({"local", {numa::Placement::SINGLE_NODE, local, {local}, 0}});
+  if (remote >= 0) {
+    configs.push_back({"remote", {numa::Placement::SINGLE_NODE, remote, {local}, 0}});
+    configs.push_back({"single", {numa::Placement::SINGLE_NODE, local, {}, 0}});
+  } else {
+    std::cout << "remote: skipped, only one NUMA node is usable\n";
+  }
+  configs.push_back({"interleave", {numa::Placement::INTERLEAVE, 0, {}, 0}});
+  configs.push_back({"replicate", {numa::Placement::REPLICATE, 0, {}, 0}});
+
+  std::cout << "layers";
+  for (int size : options.layers) std::cout << " " << size;
+  std::cout << ", batch " << options.batch << ", " << options.iters << " iterations\n\n";
+  std::cout << std::left << std::setw(12) << "placement" << std::right << std::setw(12) << "workers on"
+            << std::setw(9) << "workers"
+            << std::setw(14) << "median (ms)" << std::setw(14) << "samples/s" << "  pages per node\n";
+
+  for (const Config& config : configs) {
+    numa::Executor<float> executor(net, config.executor);
+
+    Matrix<float> output = executor.predict(input);
+    for (int r = 0; r < output.rows(); ++r) {
+      for (int c = 0; c < output.cols(); ++c) {
+        if (std::fabs(output.get(r, c) - expected.get(r, c)) > 1e-5f) {
+          std::cerr << config.name << ": output differs from NeuralNet::predict\n";
+          return 1;
+        }
+      }
+    }
+
+    std::vector<double> times;
+    for (int i = 0; i < options.iters; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      executor.predict(input);
+      times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    double median = times[times.size() / 2];
+
+    const std::vector<int>& nodes = config.executor.worker_nodes;
+    std::string workers_on = nodes.empty() ? "all" : "node " + std::to_string(nodes.front());
+    std::cout << std::left << std::setw(12) << config.name << std::right << std::setw(12) << workers_on
+              << std::setw(9) << executor.workerCount()
+              << std::setw(14) << std::fixed << std::setprecision(2) << median
+              << std::setw(14) << std::setprecision(0) << options.batch / (median / 1000.0)
+              << "  " << describePages(executor.placement()) << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,191 @@
+/* PredictionCache vs. plain predict() on traffic with repeated inputs.
+
+   Each of T threads issues R requests of B samples. A sample repeats one of
+   D "hot" feature vectors with probability P and is a fresh random vector
+   otherwise. For every memory budget the bench replays the same requests
+   through a new cache, checks every output against the uncached run
+   bit for bit, and reports samples/s, the speedup, hit rate and evictions.
+   A final pass after one train() step, and another after assigning the
+   untrained copy back, shows the cache invalidating itself.
+
+   Usage: prediction_cache_bench [--layers 64,256,256,10] [--threads T]
+                                 [--requests R] [--batch B] [--distinct D]
+                                 [--repeat P] [--budget-mb 0.25,4,64]
+                                 [--shards S] */
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "neuralnetwork.hpp"
+#include "prediction_cache.hpp"
+
+namespace {
+
+struct Options {
+  std::vector<int> layers = {64, 256, 256, 10};
+  int threads = 4;
+  int requests = 20000;
+  int batch = 1;
+  int distinct = 1000;
+  double repeat = 0.8;
+  std::vector<double> budgets_mb = {0.25, 4, 64};
+  int shards = 16;
+};
+
+template<typename U>
+std::vector<U> parseList(const std::string& value) {
+  std::vector<U> items;
+  std::stringstream ss(value);
+  std::string item;
+  while (std::getline(ss, item, ',')) items.push_back(static_cast<U>(std::stod(item)));
+  return items;
+}
+
+Options parseArgs(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    std::string value = argv[i + 1];
+    if (flag == "--layers") options.layers = parseList<int>(value);
+    else if (flag == "--threads") options.threads = std::stoi(value);
+    else if (flag == "--requests") options.requests = std::stoi(value);
+    else if (flag == "--batch") options.batch = std::stoi(value);
+    else if (flag == "--distinct") options.distinct = std::stoi(value);
+    else if (flag == "--repeat") options.repeat = std::stod(value);
+    else if (flag == "--budget-mb") options.budgets_mb = parseList<double>(value);
+    else if (flag == "--shards") options.shards = std::stoi(value);
+    else throw std::runtime_error("Unknown flag: " + flag);
+  }
+  return options;
+}
+
+/* Runs fn(thread, request) for every request of every thread and returns
+   the wall time in seconds. */
+template<typename Fn>
+double runThreads(const Options& options, Fn&& fn) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < options.threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int r = 0; r < options.requests; ++r) fn(t, r);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = parseArgs(argc, argv);
+  const int features = options.layers.front();
+
+  NeuralNet<float> net;
+  net.setLayerSizes(options.layers);
+  net.setActivation("ReLU");
+  net.setSeed(11);
+  std::cout.setstate(std::ios::failbit);  // silence build()
+  net.build();
+  std::cout.clear();
+
+  /* Request streams are generated up front so only predict() is timed. */
+  Matrix<float> hot(features, options.distinct);
+  hot.fillRandom(-1.0f, 1.0f, rng::Stream{3, 0});
+  std::vector<std::vector<Matrix<float>>> requests(options.threads);
+  for (int t = 0; t < options.threads; ++t) {
+    std::mt19937_64 gen(1000 + t);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::uniform_int_distribution<int> pick(0, options.distinct - 1);
+    for (int r = 0; r < options.requests; ++r) {
+      Matrix<float> request(features, options.batch);
+      for (int j = 0; j < options.batch; ++j) {
+        int source = coin(gen) < options.repeat ? pick(gen) : -1;
+        for (int i = 0; i < features; ++i) {
+          request.set(i, j, source >= 0 ? hot.get(i, source) : value(gen));
+        }
+      }
+      requests[t].push_back(std::move(request));
+    }
+  }
+
+  std::vector<std::vector<Matrix<float>>> expected(options.threads);
+  for (auto& outputs : expected) outputs.resize(options.requests, Matrix<float>(0, 0));
+  double plain_seconds = runThreads(options, [&](int t, int r) {
+    expected[t][r] = net.predict(requests[t][r]);
+  });
+  const double samples = static_cast<double>(options.threads) * options.requests * options.batch;
+
+  std::cout << "layers";
+  for (int size : options.layers) std::cout << " " << size;
+  std::cout << ", " << options.threads << " thread(s) x " << options.requests << " requests of batch "
+            << options.batch << ", " << options.repeat * 100 << "% repeats of " << options.distinct
+            << " hot inputs, " << options.shards << " shards\n";
+  std::cout << "uncached: " << std::fixed << std::setprecision(0) << samples / plain_seconds
+            << " samples/s\n\n";
+  std::cout << std::setw(12) << "budget (MB)" << std::setw(14) << "samples/s" << std::setw(10) << "speedup"
+            << std::setw(10) << "hit rate" << std::setw(12) << "evictions" << std::setw(10) << "entries"
+            << "\n";
+
+  for (double budget_mb : options.budgets_mb) {
+    PredictionCache<float> cache(net, static_cast<std::size_t>(budget_mb * 1024 * 1024), options.shards);
+    bool identical = true;
+    double seconds = runThreads(options, [&](int t, int r) {
+      Matrix<float> out = cache.predict(requests[t][r]);
+      const Matrix<float>& want = expected[t][r];
+      if (std::memcmp(out.data(), want.data(), sizeof(float) * want.rows() * want.cols()) != 0) {
+        identical = false;
+      }
+    });
+    if (!identical) {
+      std::cerr << "budget " << budget_mb << " MB: cached output differs from predict()\n";
+      return 1;
+    }
+
+    PredictionCache<float>::Stats stats = cache.stats();
+    std::cout << std::setw(12) << std::setprecision(2) << budget_mb << std::setprecision(0) << std::setw(14)
+              << samples / seconds << std::setprecision(2) << std::setw(9) << plain_seconds / seconds << "x"
+              << std::setprecision(3) << std::setw(10) << stats.hitRate() << std::setw(12) << stats.evictions
+              << std::setw(10) << stats.entries << "\n";
+
+    if (budget_mb == options.budgets_mb.back()) {
+      /* One training step bumps the weights version; the next lookups must
+         miss and the old entries count as invalidated. */
+      const NeuralNet<float> before = net;
+      Matrix<float> target(options.layers.back(), options.batch);
+      target.fill(0.0f);
+      net.train(requests[0][0], target, 0.01f);
+      cache.resetStats();
+      Matrix<float> after = cache.predict(requests[0][0]);
+      Matrix<float> want = net.predict(requests[0][0]);
+      stats = cache.stats();
+      bool fresh = std::memcmp(after.data(), want.data(), sizeof(float) * want.rows() * want.cols()) == 0;
+      std::cout << "\nafter train(): " << stats.misses << " miss(es), " << stats.hits << " hit(s), "
+                << stats.invalidations << " entries invalidated, output "
+                << (fresh ? "matches" : "DIFFERS FROM") << " the retrained predict()\n";
+      if (!fresh || stats.hits != 0) return 1;
+
+      /* Assigning the old copy back lowers the version again; the entries
+         cached for the trained weights must not be served for it. */
+      net = before;
+      cache.resetStats();
+      after = cache.predict(requests[0][0]);
+      want = net.predict(requests[0][0]);
+      stats = cache.stats();
+      fresh = std::memcmp(after.data(), want.data(), sizeof(float) * want.rows() * want.cols()) == 0;
+      std::cout << "after restore: " << stats.misses << " miss(es), " << stats.hits << " hit(s), "
+                << stats.invalidations << " entries invalidated, output "
+                << (fresh ? "matches" : "DIFFERS FROM") << " the restored predict()\n";
+      if (!fresh || stats.hits != 0) return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,107 @@
+/* Hyperparameter sweep engine vs. one training run per configuration.
+
+   The baseline mimics running main.cpp once per configuration: it re-reads
+   the dataset for every trial and trains each one for the full max_epochs,
+   one after the other. The sweep loads the data once into a SharedDataset
+   and prunes with successive halving, first on one thread (the gain from
+   halving alone) and then on --threads (adding parallel trials). Every run
+   uses the same split, seeds and gradient steps, so the reports show what
+   the shortcut costs in best validation loss.
+
+   Usage: sweep_bench [--data datasets/iris.data] [--max-epochs E]
+                      [--min-epochs E] [--eta N] [--threads T]
+                      [--threads-per-trial K] [--batch B] */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "loader.hpp"
+#include "sweep.hpp"
+
+namespace {
+
+struct Options {
+  std::string data = "datasets/iris.data";
+  sweep::Options sweep;
+};
+
+Options parseArgs(int argc, char** argv) {
+  Options options;
+  options.sweep.max_epochs = 300;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    std::string value = argv[i + 1];
+    if (flag == "--data") options.data = value;
+    else if (flag == "--max-epochs") options.sweep.max_epochs = std::stoi(value);
+    else if (flag == "--min-epochs") options.sweep.min_epochs = std::stoi(value);
+    else if (flag == "--eta") options.sweep.eta = std::stoi(value);
+    else if (flag == "--threads") options.sweep.threads = std::stoi(value);
+    else if (flag == "--threads-per-trial") options.sweep.threads_per_trial = std::stoi(value);
+    else if (flag == "--batch") options.sweep.batch_size = std::stoi(value);
+    else throw std::runtime_error("Unknown flag: " + flag);
+  }
+  return options;
+}
+
+void printRow(const std::string& name, double seconds, double baseline, const sweep::Result& best) {
+  std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(10) << seconds << std::setprecision(1) << std::setw(9) << baseline / seconds << "x"
+            << std::setprecision(5) << std::setw(12) << best.validation_loss << "  " << best.trial.describe()
+            << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options = parseArgs(argc, argv);
+
+  sweep::Space space;
+  space.hidden = {{4}, {6}, {8}, {16}, {8, 8}};
+  space.activations = {"Sigmoid", "Tanh", "ReLU"};
+  space.initializers = {"Xavier", "He"};
+  space.learning_rates = {0.01f, 0.05f, 0.1f, 0.5f};
+  const std::vector<sweep::Trial> trials = space.grid();
+
+  /* Baseline: parse, split and train every configuration to the end. */
+  sweep::Options full = options.sweep;
+  full.threads = 1;
+  full.min_epochs = full.max_epochs;
+  auto start = std::chrono::steady_clock::now();
+  sweep::Result baseline_best;
+  bool have_best = false;
+  for (std::size_t i = 0; i < trials.size(); ++i) {
+    sweep::SharedDataset data(loadIrisBatch(options.data), full.validation_fraction, full.seed);
+    sweep::Options single = full;
+    single.seed = full.seed + i;  // the seed the sweep gives trial i
+    sweep::Report report = sweep::run(data, {trials[i]}, single);
+    const sweep::Result& result = report.results[0];
+    if (!have_best || result.validation_loss < baseline_best.validation_loss) {
+      baseline_best = result;
+      have_best = true;
+    }
+  }
+  const double baseline = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  sweep::SharedDataset data(loadIrisBatch(options.data), options.sweep.validation_fraction, options.sweep.seed);
+  sweep::Options serial = options.sweep;
+  serial.threads = 1;
+  sweep::Report halving = sweep::run(data, trials, serial);
+  sweep::Report parallel_halving = sweep::run(data, trials, options.sweep);
+
+  std::cout << trials.size() << " configurations, " << data.trainInputs().cols() << " training / "
+            << data.validationInputs().cols() << " validation samples, epochs " << options.sweep.min_epochs
+            << ".." << options.sweep.max_epochs << ", eta " << options.sweep.eta << "\n\n";
+  std::cout << std::left << std::setw(26) << "run" << std::right << std::setw(10) << "seconds" << std::setw(10)
+            << "speedup" << std::setw(12) << "best loss" << "  best configuration\n";
+  printRow("one run per config", baseline, baseline, baseline_best);
+  printRow("halving, 1 thread", halving.seconds, baseline, halving.results[halving.best]);
+  printRow("halving, " + std::to_string(parallel::resolveThreads(options.sweep.threads)) + " thread(s)",
+           parallel_halving.seconds, baseline, parallel_halving.results[parallel_halving.best]);
+  std::cout << "\nepochs trained: " << trials.size() * static_cast<std::size_t>(options.sweep.max_epochs)
+            << " vs " << halving.epochs << " with halving\n";
+  return 0;
+}
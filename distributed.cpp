@@ -0,0 +1,399 @@
+#include "distributed.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "socket_io.hpp"
+
+namespace distributed {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x31504444;  // "DDP1"
+
+enum class MessageType : uint32_t {
+  HELLO = 1,       // worker -> server / left neighbour -> right: carries rank
+  PARAMETERS = 2,  // payload: parameterCount() float32 values
+  GRADIENT = 3,    // payload: encoded gradient (gradient_codec.hpp)
+  GOODBYE = 4,     // worker is done; the server stops after this round
+};
+
+struct MessageHeader {
+  uint32_t magic;
+  MessageType type;
+  uint32_t rank;
+  float learning_rate;
+  uint64_t payload_bytes;
+};
+
+MessageHeader makeHeader(MessageType type, int rank, float learning_rate, std::size_t payload_bytes) {
+  return MessageHeader{kMagic, type, static_cast<uint32_t>(rank), learning_rate,
+                       static_cast<uint64_t>(payload_bytes)};
+}
+
+void expect(const MessageHeader& header, MessageType type, const char* context) {
+  if (header.magic != kMagic || header.type != type) {
+    throw std::runtime_error(std::string("Unexpected message while ") + context);
+  }
+}
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::size_t chunkBegin(std::size_t count, int chunks, int chunk) {
+  return count * static_cast<std::size_t>(chunk) / static_cast<std::size_t>(chunks);
+}
+
+}  // namespace
+
+Topology topologyFromString(const std::string& name) {
+  if (name == "ps") return Topology::PARAMETER_SERVER;
+  if (name == "ring") return Topology::RING;
+  throw std::runtime_error("Unknown topology: " + name + " (expected ps or ring)");
+}
+
+std::string rankEndpoint(const std::string& endpoint, int rank) {
+  if (endpoint.rfind("tcp:", 0) == 0) {
+    std::size_t colon = endpoint.rfind(':');
+    return endpoint.substr(0, colon + 1) + std::to_string(std::stoi(endpoint.substr(colon + 1)) + rank);
+  }
+  return endpoint + "." + std::to_string(rank);
+}
+
+/* Trainer */
+
+Trainer::Trainer(NeuralNet<float>& net, Options options)
+  : net_(net), options_(std::move(options)) {
+  const int n = options_.world_size;
+  const int rank = options_.rank;
+  if (n < 1 || rank < 0 || rank >= n) {
+    throw std::runtime_error("Bad world size / rank.");
+  }
+
+  /* The destructor does not run if the constructor throws. */
+  try {
+    if (options_.topology == Topology::PARAMETER_SERVER) {
+      connectToServer();
+    } else if (n > 1) {
+      joinRing();
+    }
+  } catch (...) {
+    closeConnections();
+    throw;
+  }
+}
+
+Trainer::~Trainer() {
+  if (server_fd_ >= 0) {
+    try {
+      MessageHeader goodbye = makeHeader(MessageType::GOODBYE, options_.rank, 0.0f, 0);
+      socket_io::sendAll(server_fd_, &goodbye, sizeof(goodbye));
+    } catch (const std::exception&) {
+      // The server may already be gone; nothing to tell it then.
+    }
+  }
+  closeConnections();
+}
+
+void Trainer::connectToServer() {
+  server_fd_ = socket_io::connectEndpoint(options_.endpoint, options_.connect_timeout_ms);
+  MessageHeader hello = makeHeader(MessageType::HELLO, options_.rank, 0.0f, 0);
+  send(server_fd_, &hello, sizeof(hello));
+
+  MessageHeader header;
+  if (!receive(server_fd_, &header, sizeof(header))) {
+    throw std::runtime_error("Parameter server closed the connection.");
+  }
+  expect(header, MessageType::PARAMETERS, "waiting for the initial parameters");
+  std::vector<float> parameters(header.payload_bytes / sizeof(float));
+  if (!receive(server_fd_, parameters.data(), header.payload_bytes)) {
+    throw std::runtime_error("Parameter server closed the connection.");
+  }
+  net_.setParameters(parameters);
+}
+
+/* Listens for the left neighbour, connects to the right one, then passes
+   rank 0's parameters around so every replica starts identical. */
+void Trainer::joinRing() {
+  const int n = options_.world_size;
+  const int rank = options_.rank;
+  const std::string endpoint = rankEndpoint(options_.endpoint, rank);
+  int listen_fd = socket_io::listenEndpoint(endpoint);
+  auto closeListener = [&] {
+    socket_io::closeFd(listen_fd);
+    socket_io::removeEndpoint(endpoint);
+  };
+  try {
+    right_fd_ = socket_io::connectEndpoint(rankEndpoint(options_.endpoint, (rank + 1) % n),
+                                           options_.connect_timeout_ms);
+    MessageHeader hello = makeHeader(MessageType::HELLO, rank, 0.0f, 0);
+    send(right_fd_, &hello, sizeof(hello));
+
+    left_fd_ = socket_io::acceptConnection(listen_fd);
+    MessageHeader header;
+    if (!receive(left_fd_, &header, sizeof(header))) {
+      throw std::runtime_error("Ring neighbour closed the connection.");
+    }
+    expect(header, MessageType::HELLO, "joining the ring");
+    if (static_cast<int>(header.rank) != (rank + n - 1) % n) {
+      throw std::runtime_error("Ring neighbour has the wrong rank.");
+    }
+  } catch (...) {
+    closeListener();
+    throw;
+  }
+  closeListener();
+
+  std::vector<float> parameters;
+  if (rank == 0) {
+    parameters = net_.parameters();
+  } else {
+    parameters.resize(net_.parameterCount());
+    if (!receive(left_fd_, parameters.data(), parameters.size() * sizeof(float))) {
+      throw std::runtime_error("Ring neighbour closed the connection.");
+    }
+    net_.setParameters(parameters);
+  }
+  if (rank + 1 < n) {
+    send(right_fd_, parameters.data(), parameters.size() * sizeof(float));
+  }
+}
+
+void Trainer::closeConnections() {
+  socket_io::closeFd(server_fd_);
+  socket_io::closeFd(left_fd_);
+  socket_io::closeFd(right_fd_);
+  server_fd_ = left_fd_ = right_fd_ = -1;
+}
+
+void Trainer::send(int fd, const void* data, std::size_t size) {
+  socket_io::sendAll(fd, data, size);
+  stats_.bytes_sent += size;
+}
+
+bool Trainer::receive(int fd, void* data, std::size_t size) {
+  bool ok = socket_io::recvAll(fd, data, size);
+  if (ok) stats_.bytes_received += size;
+  return ok;
+}
+
+/* Sends to the right neighbour while receiving from the left one. */
+void Trainer::exchange(const void* send_data, std::size_t send_size, void* recv_data, std::size_t recv_size) {
+  socket_io::sendRecv(right_fd_, send_data, send_size, left_fd_, recv_data, recv_size);
+  stats_.bytes_sent += send_size;
+  stats_.bytes_received += recv_size;
+}
+
+void Trainer::step(MatrixView<const float> input, MatrixView<const float> target, float learning_rate) {
+  auto start = Clock::now();
+  gradient_ = net_.gradients(input, target);
+  stats_.compute_seconds += secondsSince(start);
+
+  start = Clock::now();
+  if (options_.topology == Topology::PARAMETER_SERVER) {
+    stepParameterServer(learning_rate);
+  } else {
+    stepRing(learning_rate);
+  }
+  stats_.communicate_seconds += secondsSince(start);
+  ++stats_.steps;
+}
+
+void Trainer::stepParameterServer(float learning_rate) {
+  feedback_.encode(gradient_, options_.compression, options_.top_k_ratio, encoded_);
+  MessageHeader header = makeHeader(MessageType::GRADIENT, options_.rank, learning_rate, encoded_.size());
+  send(server_fd_, &header, sizeof(header));
+  send(server_fd_, encoded_.data(), encoded_.size());
+
+  if (!receive(server_fd_, &header, sizeof(header))) {
+    throw std::runtime_error("Parameter server closed the connection.");
+  }
+  expect(header, MessageType::PARAMETERS, "waiting for updated parameters");
+  std::vector<float> parameters(header.payload_bytes / sizeof(float));
+  if (!receive(server_fd_, parameters.data(), header.payload_bytes)) {
+    throw std::runtime_error("Parameter server closed the connection.");
+  }
+  net_.setParameters(parameters);
+}
+
+void Trainer::stepRing(float learning_rate) {
+  const int n = options_.world_size;
+  if (n > 1) {
+    if (options_.compression == Compression::TOP_K) {
+      ringAllGatherSparse();
+    } else {
+      ringAllReduce();
+    }
+    const float scale = 1.0f / static_cast<float>(n);
+    for (float& g : gradient_) g *= scale;
+  }
+  net_.applyGradients(gradient_, learning_rate);
+}
+
+/* Reduce-scatter then all-gather over n chunks. In step s of the first
+   phase rank r sends chunk r - s and adds the incoming chunk r - s - 1, so
+   after n - 1 steps it holds the full sum of chunk r + 1; the second phase
+   circulates those sums. Every hop is encoded with the configured codec.
+   Owners quantize their sums before circulating them, so all ranks end up
+   with bit-identical gradients. */
+void Trainer::ringAllReduce() {
+  const int n = options_.world_size;
+  const int rank = options_.rank;
+  const std::size_t count = gradient_.size();
+  const Compression codec = options_.compression;
+
+  /* Lossy codecs: error feedback on this worker's own contribution, which
+     then enters the ring already quantized. */
+  if (codec != Compression::NONE) {
+    feedback_.encode(gradient_, codec, options_.top_k_ratio, encoded_);
+    std::fill(gradient_.begin(), gradient_.end(), 0.0f);
+    decodeAdd(encoded_.data(), encoded_.size(), gradient_.data(), count);
+  }
+
+  auto pass = [&](int send_chunk, int recv_chunk, bool accumulate) {
+    std::size_t send_begin = chunkBegin(count, n, send_chunk);
+    std::size_t send_count = chunkBegin(count, n, send_chunk + 1) - send_begin;
+    std::size_t recv_begin = chunkBegin(count, n, recv_chunk);
+    std::size_t recv_count = chunkBegin(count, n, recv_chunk + 1) - recv_begin;
+
+    encode(gradient_.data() + send_begin, send_count, codec, options_.top_k_ratio, encoded_);
+    uint64_t send_size = encoded_.size();
+    uint64_t recv_size = 0;
+    exchange(&send_size, sizeof(send_size), &recv_size, sizeof(recv_size));
+    received_.resize(recv_size);
+    exchange(encoded_.data(), encoded_.size(), received_.data(), received_.size());
+
+    float* target = gradient_.data() + recv_begin;
+    if (!accumulate) {
+      std::fill(target, target + recv_count, 0.0f);
+    }
+    decodeAdd(received_.data(), received_.size(), target, recv_count);
+  };
+
+  for (int s = 0; s < n - 1; ++s) {
+    pass((rank - s + n) % n, (rank - s - 1 + n) % n, true);
+  }
+
+  const int owned = (rank + 1) % n;
+  if (codec != Compression::NONE) {
+    std::size_t begin = chunkBegin(count, n, owned);
+    std::size_t size = chunkBegin(count, n, owned + 1) - begin;
+    encode(gradient_.data() + begin, size, codec, options_.top_k_ratio, encoded_);
+    std::fill(gradient_.begin() + begin, gradient_.begin() + begin + size, 0.0f);
+    decodeAdd(encoded_.data(), encoded_.size(), gradient_.data() + begin, size);
+  }
+
+  for (int s = 0; s < n - 1; ++s) {
+    pass((owned - s + n) % n, (owned - s - 1 + n) % n, false);
+  }
+}
+
+/* Sparse gradients do not stay sparse when summed hop by hop, so each
+   worker's encoded top-k message travels the whole ring instead and every
+   rank sums all n messages in rank order. */
+void Trainer::ringAllGatherSparse() {
+  const int n = options_.world_size;
+  const int rank = options_.rank;
+
+  std::vector<std::vector<char>> messages(n);
+  feedback_.encode(gradient_, options_.compression, options_.top_k_ratio, messages[rank]);
+
+  for (int s = 0; s < n - 1; ++s) {
+    const std::vector<char>& outgoing = messages[(rank - s + n) % n];
+    std::vector<char>& incoming = messages[(rank - s - 1 + n) % n];
+    uint64_t send_size = outgoing.size();
+    uint64_t recv_size = 0;
+    exchange(&send_size, sizeof(send_size), &recv_size, sizeof(recv_size));
+    incoming.resize(recv_size);
+    exchange(outgoing.data(), outgoing.size(), incoming.data(), incoming.size());
+  }
+
+  std::fill(gradient_.begin(), gradient_.end(), 0.0f);
+  for (const std::vector<char>& message : messages) {
+    decodeAdd(message.data(), message.size(), gradient_.data(), gradient_.size());
+  }
+}
+
+/* ParameterServer */
+
+ParameterServer::ParameterServer(NeuralNet<float>& net, Options options)
+  : net_(net), options_(std::move(options)) {
+  listen_fd_ = socket_io::listenEndpoint(options_.endpoint);
+}
+
+ParameterServer::~ParameterServer() {
+  for (int fd : worker_fds_) {
+    socket_io::closeFd(fd);
+  }
+  socket_io::closeFd(listen_fd_);
+  socket_io::removeEndpoint(options_.endpoint);
+}
+
+void ParameterServer::run() {
+  const int n = options_.world_size;
+  worker_fds_.assign(n, -1);
+  for (int accepted = 0; accepted < n; ++accepted) {
+    int fd = socket_io::acceptConnection(listen_fd_);
+    MessageHeader hello;
+    if (!socket_io::recvAll(fd, &hello, sizeof(hello))) {
+      socket_io::closeFd(fd);
+      --accepted;
+      continue;
+    }
+    try {
+      expect(hello, MessageType::HELLO, "accepting workers");
+      if (static_cast<int>(hello.rank) >= n || worker_fds_[hello.rank] >= 0) {
+        throw std::runtime_error("Worker sent a bad or duplicate rank.");
+      }
+    } catch (...) {
+      socket_io::closeFd(fd);
+      throw;
+    }
+    worker_fds_[hello.rank] = fd;
+  }
+
+  auto broadcast = [&](const std::vector<float>& parameters) {
+    MessageHeader header = makeHeader(MessageType::PARAMETERS, 0, 0.0f, parameters.size() * sizeof(float));
+    for (int fd : worker_fds_) {
+      socket_io::sendAll(fd, &header, sizeof(header));
+      socket_io::sendAll(fd, parameters.data(), parameters.size() * sizeof(float));
+    }
+  };
+  broadcast(net_.parameters());
+
+  const std::size_t count = net_.parameterCount();
+  std::vector<float> sum(count);
+  std::vector<char> payload;
+  for (;;) {
+    /* Gradients are summed in rank order so the result does not depend on
+       which worker finishes its batch first. */
+    std::fill(sum.begin(), sum.end(), 0.0f);
+    float learning_rate = 0.0f;
+    for (int rank = 0; rank < n; ++rank) {
+      MessageHeader header;
+      if (!socket_io::recvAll(worker_fds_[rank], &header, sizeof(header)) ||
+          header.type == MessageType::GOODBYE) {
+        return;
+      }
+      expect(header, MessageType::GRADIENT, "waiting for gradients");
+      payload.resize(header.payload_bytes);
+      if (!socket_io::recvAll(worker_fds_[rank], payload.data(), payload.size())) {
+        return;  // disconnected between header and payload: same as leaving
+      }
+      decodeAdd(payload.data(), payload.size(), sum.data(), count);
+      if (rank == 0) learning_rate = header.learning_rate;
+    }
+
+    const float scale = 1.0f / static_cast<float>(n);
+    for (float& g : sum) g *= scale;
+    net_.applyGradients(sum, learning_rate);
+    ++steps_;
+    broadcast(net_.parameters());
+  }
+}
+
+}  // namespace distributed
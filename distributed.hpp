@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gradient_codec.hpp"
+#include "matrix.hpp"
+#include "neuralnetwork.hpp"
+
+/* Synchronous data-parallel training across processes.
+
+   Every worker holds a full NeuralNet<float>, computes the gradient of its
+   own batch (NeuralNet::gradients) and exchanges it, compressed, with the
+   others over Unix-domain or TCP sockets. All workers then take the same
+   step with the averaged gradient, so replicas stay identical.
+
+   Two topologies:
+   - PARAMETER_SERVER: workers send gradients to a ParameterServer process,
+     which averages them in rank order, updates the master copy and sends the
+     new parameters (float32) back to every worker.
+   - RING: workers form a ring, rank r sending to rank r + 1. Dense codecs
+     use a ring all-reduce (reduce-scatter, then all-gather of the reduced
+     chunks); TOP_K gathers every worker's sparse gradient around the ring
+     and sums them in rank order.
+
+   Lossy codecs use error feedback (ErrorFeedback). Every worker must call
+   step() the same number of times. */
+namespace distributed {
+
+enum class Topology {
+  PARAMETER_SERVER,
+  RING,
+};
+
+struct Options {
+  Topology topology = Topology::PARAMETER_SERVER;
+  Compression compression = Compression::NONE;
+  double top_k_ratio = 0.01;
+  /* "unix:<path>" or "tcp:<host>:<port>". PARAMETER_SERVER: the server's
+     address. RING: rank r listens on rankEndpoint(endpoint, r). */
+  std::string endpoint;
+  int world_size = 1;
+  int rank = 0;
+  int connect_timeout_ms = 10000;
+};
+
+Topology topologyFromString(const std::string& name);  // "ps", "ring"
+
+/* "unix:/tmp/x" -> "unix:/tmp/x.<rank>", "tcp:h:5000" -> "tcp:h:<5000 + rank>". */
+std::string rankEndpoint(const std::string& endpoint, int rank);
+
+struct Stats {
+  std::size_t steps = 0;
+  double compute_seconds = 0.0;      // forward/backward
+  double communicate_seconds = 0.0;  // encoding, exchange, update
+  std::size_t bytes_sent = 0;
+  std::size_t bytes_received = 0;
+};
+
+class Trainer {
+public:
+  /* Connects to the server or the ring neighbours. With a parameter server
+     the network's parameters are replaced by the server's initial copy. */
+  Trainer(NeuralNet<float>& net, Options options);
+  ~Trainer();
+
+  Trainer(const Trainer&) = delete;
+  Trainer& operator=(const Trainer&) = delete;
+
+  /* One synchronous SGD step on this worker's features x batch shard. */
+  void step(MatrixView<const float> input, MatrixView<const float> target, float learning_rate);
+
+  const Stats& stats() const { return stats_; }
+  const Options& options() const { return options_; }
+
+private:
+  void connectToServer();
+  void joinRing();
+  void closeConnections();
+
+  void stepParameterServer(float learning_rate);
+  void stepRing(float learning_rate);
+  void ringAllReduce();
+  void ringAllGatherSparse();
+
+  void send(int fd, const void* data, std::size_t size);
+  bool receive(int fd, void* data, std::size_t size);
+  void exchange(const void* send_data, std::size_t send_size, void* recv_data, std::size_t recv_size);
+
+  NeuralNet<float>& net_;
+  Options options_;
+  Stats stats_;
+  ErrorFeedback feedback_;
+
+  int server_fd_ = -1;
+  int left_fd_ = -1;   // ring: receives from rank - 1
+  int right_fd_ = -1;  // ring: sends to rank + 1
+
+  std::vector<float> gradient_;
+  std::vector<char> encoded_;
+  std::vector<char> received_;
+};
+
+/* Owns the master copy of the parameters for the PARAMETER_SERVER topology.
+   run() accepts options.world_size workers, serves steps until one of them
+   says goodbye, then returns; `net` then holds the trained parameters. */
+class ParameterServer {
+public:
+  ParameterServer(NeuralNet<float>& net, Options options);
+  ~ParameterServer();
+
+  ParameterServer(const ParameterServer&) = delete;
+  ParameterServer& operator=(const ParameterServer&) = delete;
+
+  void run();
+  std::size_t steps() const { return steps_; }
+
+private:
+  NeuralNet<float>& net_;
+  Options options_;
+  int listen_fd_ = -1;
+  std::vector<int> worker_fds_;  // by rank
+  std::size_t steps_ = 0;
+};
+
+}  // namespace distributed
@@ -0,0 +1,312 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "activation.hpp"
+#include "matrix.hpp"
+#include "neuralnetwork.hpp"
+#include "parallel.hpp"
+
+/* Batched inference for an ensemble of networks with the same topology and
+   activation (e.g. one model trained with several seeds).
+
+   The members' parameters are interleaved so that the member index has unit
+   stride: for layer l, weights_[l] row (r * in_l + k) holds W_m(r, k) for
+   every member m, and biases_[l] row r holds b_m(r). Activations are kept as
+   width x (members * batch) with column m * batch + j for sample j of member
+   m. One pass over layer l is then a single batched GEMM
+
+     Z(r, m * batch + j) = sum_k W_m(r, k) * A(k, m * batch + j)
+
+   whose innermost loop runs over members and samples with unit stride, so
+   the ensemble costs one loop nest per layer rather than one predict() per
+   member. Layer 0 reads the shared input directly. Bias and activation are
+   fused into one pass over each layer's output, and the last layer's bias
+   and activation into the mean/vote reduction.
+
+   Each Z element is summed over k in ascending order from zero, as in
+   matMul, so every member's output is bit-identical to its own predict().
+   Members are split into contiguous ranges, one per thread, and the
+   reduction walks members in order: results do not depend on the thread
+   count. */
+template<typename T>
+class Ensemble {
+public:
+  enum class Reduction {
+    MEAN,  // average of the members' outputs
+    VOTE,  // fraction of members whose argmax is each class
+  };
+
+  /* threads <= 0 uses every core. */
+  explicit Ensemble(const std::vector<NeuralNet<T>>& members, int threads = 0);
+
+  /* input is features x batch; returns outputs x batch. */
+  Matrix<T> predict(MatrixView<const T> input, Reduction reduction = Reduction::MEAN) const;
+
+  /* Every member's output: (members * outputs) x batch, member m in rows
+     [m * outputs, (m + 1) * outputs), i.e. its own predict() result. */
+  Matrix<T> predictMembers(MatrixView<const T> input) const;
+
+  std::size_t size() const { return members_; }
+  const std::vector<int>& layerSizes() const { return layer_sizes_; }
+  void setThreads(int threads) { threads_ = parallel::resolveThreads(threads); }
+
+private:
+  std::vector<int> layer_sizes_;
+  std::size_t members_ = 0;
+  activation::Type activation_;
+  int threads_;
+  std::vector<Matrix<T>> weights_;  // (out_l * in_l) x members per layer
+  std::vector<Matrix<T>> biases_;   // out_l x members per layer
+
+  /* Runs every layer for members [first, last), writing their columns of
+     each entry of z (out_l x members * batch). The last layer is left before
+     bias and activation; callers fuse those into their own pass. */
+  void forwardMembers(std::size_t first, std::size_t last, MatrixView<const T> input,
+                      std::vector<Matrix<T>>& z) const;
+  Matrix<T> forwardAll(MatrixView<const T> input) const;
+};
+
+/* Implementations */
+namespace detail {
+
+/* Calls fn with the activation as an inlinable callable instead of a
+   std::function, so the fused loops below do not pay an indirect call per
+   element. */
+template<typename T, typename Fn>
+void withActivation(activation::Type type, Fn&& fn) {
+  switch (type) {
+    case activation::Type::SIGMOID: fn(activation::sigmoid<T>); break;
+    case activation::Type::TANH: fn(activation::tanh_fn<T>); break;
+    case activation::Type::RELU: fn(activation::relu<T>); break;
+    case activation::Type::LEAKY_RELU: fn(activation::leaky_relu<T>); break;
+  }
+}
+
+/* z[j] = f(z[j] + bias[j * bias_stride]) over n elements, in blocks of
+   eight like detail::axpy so that branchy activations such as ReLU become
+   SIMD selects instead of data-dependent branches. */
+template<typename T, typename F>
+inline void biasActivate(int n, const T* bias, std::ptrdiff_t bias_stride, F f, T* z) {
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    T block[8];
+    for (int u = 0; u < 8; ++u) block[u] = f(z[j + u] + bias[(j + u) * bias_stride]);
+    for (int u = 0; u < 8; ++u) z[j + u] = block[u];
+  }
+  for (; j < n; ++j) {
+    z[j] = f(z[j] + bias[j * bias_stride]);
+  }
+}
+
+}  // namespace detail
+
+template<typename T>
+Ensemble<T>::Ensemble(const std::vector<NeuralNet<T>>& members, int threads)
+  : threads_(parallel::resolveThreads(threads)) {
+  if (members.empty()) {
+    throw std::runtime_error("Ensemble needs at least one member.");
+  }
+  const NeuralNet<T>& first = members.front();
+  if (first.weights().empty()) {
+    throw std::runtime_error("Ensemble members must be built or loaded.");
+  }
+  for (const NeuralNet<T>& member : members) {
+    if (member.layerSizes() != first.layerSizes() || member.activationName() != first.activationName() ||
+        member.weights().size() != first.weights().size()) {
+      throw std::runtime_error("Ensemble members must share layer sizes and activation.");
+    }
+  }
+
+  layer_sizes_ = first.layerSizes();
+  members_ = members.size();
+  activation_ = activation::fromString(first.activationName());
+
+  const int count = static_cast<int>(members_);
+  for (std::size_t l = 0; l + 1 < layer_sizes_.size(); ++l) {
+    const int out = layer_sizes_[l + 1];
+    const int in = layer_sizes_[l];
+    Matrix<T> weights(out * in, count);
+    Matrix<T> biases(out, count);
+    for (int m = 0; m < count; ++m) {
+      const T* w = members[m].weights()[l].data();
+      const T* b = members[m].biases()[l].data();
+      for (int i = 0; i < out * in; ++i) weights.data()[static_cast<std::ptrdiff_t>(i) * count + m] = w[i];
+      for (int r = 0; r < out; ++r) biases.data()[static_cast<std::ptrdiff_t>(r) * count + m] = b[r];
+    }
+    weights_.push_back(std::move(weights));
+    biases_.push_back(std::move(biases));
+  }
+}
+
+template<typename T>
+void Ensemble<T>::forwardMembers(std::size_t first, std::size_t last, MatrixView<const T> input,
+                                 std::vector<Matrix<T>>& z) const {
+  const std::ptrdiff_t count = static_cast<std::ptrdiff_t>(members_);
+  const std::ptrdiff_t m0 = static_cast<std::ptrdiff_t>(first);
+  const std::ptrdiff_t m1 = static_cast<std::ptrdiff_t>(last);
+  const int batch = input.cols();
+  const std::ptrdiff_t width = count * batch;
+
+  for (std::size_t l = 0; l < weights_.size(); ++l) {
+    const int out = layer_sizes_[l + 1];
+    const int in = layer_sizes_[l];
+    const T* w = weights_[l].data();
+    T* dst = z[l].data();
+
+    /* Row k of this layer's input for member m (the shared sample for layer 0). */
+    auto input_row = [&](int k, std::ptrdiff_t m) -> const T* {
+      if (l == 0) return input.data() + static_cast<std::ptrdiff_t>(k) * input.rowStride();
+      return z[l - 1].data() + static_cast<std::ptrdiff_t>(k) * width + m * batch;
+    };
+
+    if (batch == 1) {
+      /* One sample: the innermost loop runs across members. */
+      for (int r = 0; r < out; ++r) {
+        T* z_row = dst + r * width;
+        std::fill(z_row + m0, z_row + m1, T{});
+        for (int k = 0; k < in; ++k) {
+          const T* w_rk = w + (static_cast<std::ptrdiff_t>(r) * in + k) * count;
+          if (l == 0) {
+            detail::axpy<T>(static_cast<int>(m1 - m0), input_row(k, 0)[0], w_rk + m0, z_row + m0);
+          } else {
+            detail::multiplyAdd<T>(static_cast<int>(m1 - m0), w_rk + m0, input_row(k, m0), z_row + m0);
+          }
+        }
+      }
+    } else {
+      /* A batch: member by member, so one member's activations stay in cache
+         while the innermost loop runs across its samples. */
+      const bool strided = l == 0 && input.colStride() != 1;
+      for (std::ptrdiff_t m = m0; m < m1; ++m) {
+        for (int r = 0; r < out; ++r) {
+          T* z_m = dst + r * width + m * batch;
+          std::fill(z_m, z_m + batch, T{});
+          for (int k = 0; k < in; ++k) {
+            const T w_rkm = w[(static_cast<std::ptrdiff_t>(r) * in + k) * count + m];
+            const T* a = input_row(k, m);
+            if (strided) {
+              for (int j = 0; j < batch; ++j) z_m[j] += w_rkm * a[j * input.colStride()];
+            } else {
+              detail::axpy<T>(batch, w_rkm, a, z_m);
+            }
+          }
+        }
+      }
+    }
+
+    if (l + 1 == weights_.size()) {
+      break;
+    }
+
+    /* Fused bias + activation of this layer's columns. */
+    const T* bias = biases_[l].data();
+    detail::withActivation<T>(activation_, [&](auto f) {
+      for (int r = 0; r < out; ++r) {
+        T* z_row = dst + r * width;
+        if (batch == 1) {
+          detail::biasActivate<T>(static_cast<int>(m1 - m0), bias + r * count + m0, 1, f, z_row + m0);
+          continue;
+        }
+        for (std::ptrdiff_t m = m0; m < m1; ++m) {
+          detail::biasActivate<T>(batch, bias + r * count + m, 0, f, z_row + m * batch);
+        }
+      }
+    });
+  }
+}
+
+template<typename T>
+Matrix<T> Ensemble<T>::forwardAll(MatrixView<const T> input) const {
+  assert(input.rows() == layer_sizes_.front());
+  const int width = static_cast<int>(members_) * input.cols();
+
+  std::vector<Matrix<T>> z;
+  z.reserve(weights_.size());
+  for (std::size_t l = 0; l < weights_.size(); ++l) {
+    z.emplace_back(layer_sizes_[l + 1], width);
+  }
+
+  parallel::forRange(members_, threads_, [&](std::size_t first, std::size_t last) {
+    forwardMembers(first, last, input, z);
+  });
+  return std::move(z.back());
+}
+
+template<typename T>
+Matrix<T> Ensemble<T>::predictMembers(MatrixView<const T> input) const {
+  const Matrix<T> z = forwardAll(input);
+  const int outputs = layer_sizes_.back();
+  const int batch = input.cols();
+  const std::ptrdiff_t count = static_cast<std::ptrdiff_t>(members_);
+  const T* bias = biases_.back().data();
+
+  Matrix<T> result(static_cast<int>(members_) * outputs, batch);
+  detail::withActivation<T>(activation_, [&](auto f) {
+    for (std::ptrdiff_t m = 0; m < count; ++m) {
+      for (int c = 0; c < outputs; ++c) {
+        const T* src = z.data() + c * count * batch + m * batch;
+        T* dst = result.data() + (m * outputs + c) * batch;
+        for (int j = 0; j < batch; ++j) dst[j] = f(src[j] + bias[c * count + m]);
+      }
+    }
+  });
+  return result;
+}
+
+template<typename T>
+Matrix<T> Ensemble<T>::predict(MatrixView<const T> input, Reduction reduction) const {
+  const Matrix<T> z = forwardAll(input);
+  const int outputs = layer_sizes_.back();
+  const int batch = input.cols();
+  const std::ptrdiff_t count = static_cast<std::ptrdiff_t>(members_);
+  const T* bias = biases_.back().data();
+
+  Matrix<T> result(outputs, batch);
+  result.fill(T{});
+  T* out = result.data();
+
+  /* Fused final pass: bias and activation of the last layer, then the
+     reduction, without writing the activated member outputs back. */
+  detail::withActivation<T>(activation_, [&](auto f) {
+    if (reduction == Reduction::MEAN) {
+      for (int c = 0; c < outputs; ++c) {
+        const T* z_row = z.data() + c * count * batch;
+        T* sum = out + static_cast<std::ptrdiff_t>(c) * batch;
+        for (std::ptrdiff_t m = 0; m < count; ++m) {
+          const T b = bias[c * count + m];
+          for (int j = 0; j < batch; ++j) sum[j] += f(z_row[m * batch + j] + b);
+        }
+        const T scale = T(1) / static_cast<T>(members_);
+        for (int j = 0; j < batch; ++j) sum[j] *= scale;
+      }
+      return;
+    }
+
+    /* Vote: argmax over the activated outputs, so ties (ReLU clamping,
+       saturated sigmoids) break exactly as for the member's own predict(). */
+    const T weight = T(1) / static_cast<T>(members_);
+    for (std::ptrdiff_t m = 0; m < count; ++m) {
+      for (int j = 0; j < batch; ++j) {
+        auto value = [&](int c) { return f(z.data()[(c * count + m) * batch + j] + bias[c * count + m]); };
+        int best = 0;
+        T best_value = value(0);
+        for (int c = 1; c < outputs; ++c) {
+          T v = value(c);
+          if (v > best_value) {
+            best_value = v;
+            best = c;
+          }
+        }
+        out[static_cast<std::ptrdiff_t>(best) * batch + j] += weight;
+      }
+    }
+  });
+  return result;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "matrix.hpp"
+#include "neuralnetwork.hpp"
+#include "parallel.hpp"
+
+namespace evaluation {
+
+struct Options {
+  std::size_t batch_size = 256;  // samples pushed through predict() at once
+  int threads = 0;               // <= 0 uses every core
+  int top_k = 1;                 // also count a hit if the class is in the top k
+};
+
+/* Metrics for one pass over a dataset. Loss is the mean squared error over
+   all outputs, matching the (output - target) error used by train(). The
+   confusion matrix is indexed [true class][predicted class]. */
+struct Report {
+  std::size_t samples = 0;
+  std::size_t correct = 0;
+  std::size_t top_k_correct = 0;
+  int top_k = 1;
+  double squared_error = 0.0;
+  std::size_t outputs = 0;
+  std::vector<std::vector<std::size_t>> confusion;
+  double seconds = 0.0;
+
+  double accuracy() const { return samples ? static_cast<double>(correct) / samples : 0.0; }
+  double topKAccuracy() const { return samples ? static_cast<double>(top_k_correct) / samples : 0.0; }
+  double loss() const { return samples ? squared_error / (static_cast<double>(samples) * outputs) : 0.0; }
+  double samplesPerSecond() const { return seconds > 0.0 ? samples / seconds : 0.0; }
+
+  void merge(const Report& other);
+  void print(std::ostream& out = std::cout) const;
+};
+
+/* Streams the columns of `inputs`/`targets` through batched predict() calls.
+   Consecutive batches are divided among threads, each thread reduces into its
+   own Report, and the partial reports are merged in batch order. */
+template<typename T>
+Report evaluate(const NeuralNet<T>& net, typename Matrix<T>::ConstView inputs, typename Matrix<T>::ConstView targets,
+                const Options& options = Options());
+
+/* Runs evaluate() on a background thread. The network is taken by value, so
+   the caller keeps training while the snapshot is evaluated; the input and
+   target views must stay valid until the future is ready. */
+template<typename T>
+std::future<Report> evaluateAsync(NeuralNet<T> snapshot, typename Matrix<T>::ConstView inputs,
+                                  typename Matrix<T>::ConstView targets, Options options = Options());
+
+/* Implementations */
+inline void Report::merge(const Report& other) {
+  samples += other.samples;
+  correct += other.correct;
+  top_k_correct += other.top_k_correct;
+  squared_error += other.squared_error;
+  if (confusion.size() < other.confusion.size()) {
+    confusion.resize(other.confusion.size(), std::vector<std::size_t>(other.confusion.size(), 0));
+  }
+  for (std::size_t i = 0; i < other.confusion.size(); ++i) {
+    for (std::size_t j = 0; j < other.confusion[i].size(); ++j) {
+      confusion[i][j] += other.confusion[i][j];
+    }
+  }
+}
+
+inline void Report::print(std::ostream& out) const {
+  out << "Samples: " << samples << "\n";
+  out << "Accuracy: " << accuracy() * 100.0 << "%\n";
+  if (top_k > 1) {
+    out << "Top-" << top_k << " accuracy: " << topKAccuracy() * 100.0 << "%\n";
+  }
+  out << "Loss (MSE): " << loss() << "\n";
+  out << "Throughput: " << samplesPerSecond() << " samples/s (" << seconds << " s)\n";
+  out << "Confusion matrix (rows: true, cols: predicted):\n";
+  for (const auto& row : confusion) {
+    for (std::size_t count : row) {
+      out << std::setw(8) << count;
+    }
+    out << "\n";
+  }
+}
+
+template<typename T>
+Report evaluate(const NeuralNet<T>& net, typename Matrix<T>::ConstView inputs, typename Matrix<T>::ConstView targets,
+                const Options& options) {
+  assert(inputs.cols() == targets.cols());
+
+  const int classes = targets.rows();
+  const std::size_t samples = static_cast<std::size_t>(inputs.cols());
+  const std::size_t batch_size = std::max<std::size_t>(options.batch_size, 1);
+  const std::size_t batches = (samples + batch_size - 1) / batch_size;
+  const int threads = static_cast<int>(std::min<std::size_t>(
+      static_cast<std::size_t>(parallel::resolveThreads(options.threads)), std::max<std::size_t>(batches, 1)));
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<Report> partials(threads);
+  for (auto& partial : partials) {
+    partial.confusion.assign(classes, std::vector<std::size_t>(classes, 0));
+  }
+
+  /* One contiguous run of batches per thread, each reducing into its own
+     partial report; partials are merged in order so results are stable. */
+  parallel::forRange(static_cast<std::size_t>(threads), threads, [&](std::size_t chunk_begin, std::size_t chunk_end) {
+    for (std::size_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+      Report& partial = partials[chunk];
+      std::size_t first = chunk * batches / threads;
+      std::size_t last = (chunk + 1) * batches / threads;
+
+      for (std::size_t b = first; b < last; ++b) {
+        int begin = static_cast<int>(b * batch_size);
+        int count = static_cast<int>(std::min(batch_size, samples - b * batch_size));
+        Matrix<T> output = net.predict(inputs.block(0, begin, inputs.rows(), count));
+        MatrixView<const T> target = targets.block(0, begin, classes, count);
+
+        for (int c = 0; c < count; ++c) {
+          int predicted = 0;
+          int truth = 0;
+          for (int r = 1; r < classes; ++r) {
+            if (output.get(r, c) > output.get(predicted, c)) predicted = r;
+            if (target(r, c) > target(truth, c)) truth = r;
+          }
+
+          int ranked_above = 0;
+          for (int r = 0; r < classes; ++r) {
+            double diff = static_cast<double>(output.get(r, c)) - static_cast<double>(target(r, c));
+            partial.squared_error += diff * diff;
+            if (output.get(r, c) > output.get(truth, c)) ++ranked_above;
+          }
+
+          partial.correct += predicted == truth;
+          partial.top_k_correct += ranked_above < options.top_k;
+          ++partial.confusion[truth][predicted];
+        }
+        partial.samples += count;
+      }
+    }
+  });
+
+  Report report;
+  report.top_k = options.top_k;
+  report.outputs = static_cast<std::size_t>(classes);
+  report.confusion.assign(classes, std::vector<std::size_t>(classes, 0));
+  for (const auto& partial : partials) {
+    report.merge(partial);
+  }
+  report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return report;
+}
+
+template<typename T>
+std::future<Report> evaluateAsync(NeuralNet<T> snapshot, typename Matrix<T>::ConstView inputs,
+                                  typename Matrix<T>::ConstView targets, Options options) {
+  return std::async(std::launch::async,
+                    [net = std::move(snapshot), inputs, targets, options]() {
+                      parallel::Region region;  // runs alongside training
+                      return evaluate<T>(net, inputs, targets, options);
+                    });
+}
+
+}  // namespace evaluation
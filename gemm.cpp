@@ -0,0 +1,152 @@
+#include "gemm.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace gemm {
+
+namespace {
+
+/* Cache file layout, tab separated because CPU model names contain spaces:
+     # neuralnet gemm tuning cache v1
+     <cpu model>\t<element_size> <m> <n> <k>\t<mc> <nc> <kc> <mr> <threads> */
+const char* const kCacheHeader = "# neuralnet gemm tuning cache v1";
+
+struct Line {
+  std::string cpu;
+  Shape shape;
+  Config config;
+};
+
+bool parseLine(const std::string& text, Line& line) {
+  std::size_t tab1 = text.find('\t');
+  std::size_t tab2 = tab1 == std::string::npos ? tab1 : text.find('\t', tab1 + 1);
+  if (tab2 == std::string::npos) {
+    return false;
+  }
+  line.cpu = text.substr(0, tab1);
+
+  std::istringstream shape(text.substr(tab1 + 1, tab2 - tab1 - 1));
+  std::istringstream config(text.substr(tab2 + 1));
+  Shape& s = line.shape;
+  Config& c = line.config;
+  return static_cast<bool>(shape >> s.element_size >> s.m >> s.n >> s.k) &&
+         static_cast<bool>(config >> c.mc >> c.nc >> c.kc >> c.mr >> c.threads);
+}
+
+std::string formatLine(const std::string& cpu, const Shape& s, const Config& c) {
+  std::ostringstream out;
+  out << cpu << '\t' << s.element_size << ' ' << s.m << ' ' << s.n << ' ' << s.k << '\t'
+      << c.mc << ' ' << c.nc << ' ' << c.kc << ' ' << c.mr << ' ' << c.threads;
+  return out.str();
+}
+
+}  // namespace
+
+std::string cpuModel() {
+  static const std::string model = [] {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.rfind("model name", 0) != 0) continue;
+      std::size_t colon = line.find(':');
+      if (colon == std::string::npos) continue;
+      std::size_t start = line.find_first_not_of(" \t", colon + 1);
+      return start == std::string::npos ? std::string("unknown") : line.substr(start);
+    }
+    return std::string("unknown");
+  }();
+  return model;
+}
+
+std::string defaultCachePath() {
+  if (const char* path = std::getenv("NN_GEMM_CACHE")) {
+    return path;
+  }
+  if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+    return std::string(xdg) + "/neuralnet/gemm.cache";
+  }
+  if (const char* home = std::getenv("HOME"); home && *home) {
+    return std::string(home) + "/.cache/neuralnet/gemm.cache";
+  }
+  return "gemm.cache";
+}
+
+bool Table::load(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+
+  const std::string cpu = cpuModel();
+  std::string text;
+  Line line;
+  std::vector<std::pair<Shape, Config>> configs;
+  while (std::getline(in, text)) {
+    if (text.empty() || text[0] == '#') continue;
+    if (parseLine(text, line) && line.cpu == cpu) {
+      configs.emplace_back(line.shape, line.config);
+    }
+  }
+  set(configs);
+  return true;
+}
+
+bool Table::save(const std::string& path) const {
+  const std::string cpu = cpuModel();
+  std::vector<std::string> kept;
+  {
+    std::ifstream in(path);
+    std::string text;
+    Line line;
+    while (std::getline(in, text)) {
+      if (!parseLine(text, line)) continue;
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (line.cpu != cpu || entries_.count(line.shape) == 0) {
+        kept.push_back(text);
+      }
+    }
+  }
+
+  std::filesystem::path target(path);
+  std::error_code error;
+  if (target.has_parent_path()) {
+    std::filesystem::create_directories(target.parent_path(), error);
+  }
+
+  /* Written next to the cache and renamed over it, so a concurrent load()
+     sees either the old or the new file. */
+  std::string temp = path + ".tmp";
+  {
+    std::ofstream out(temp, std::ios::trunc);
+    if (!out) {
+      return false;
+    }
+    out << kCacheHeader << "\n";
+    for (const std::string& text : kept) {
+      out << text << "\n";
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+      out << formatLine(cpu, entry.first, entry.second) << "\n";
+    }
+    if (!out) {
+      return false;
+    }
+  }
+  return std::rename(temp.c_str(), path.c_str()) == 0;
+}
+
+void Table::loadDefaultCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (default_cache_loaded_) return;
+    default_cache_loaded_ = true;
+  }
+  load(defaultCachePath());
+}
+
+}  // namespace gemm
@@ -0,0 +1,307 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "aligned_allocator.hpp"
+#include "parallel.hpp"
+
+/* Cache-blocked GEMM (out = a * b) whose blocking is chosen per shape, plus
+   the process-wide table of tuned shapes that matMulInto() consults.
+
+   Shapes missing from the table keep using the reference kernel in
+   matrix.hpp, so nothing changes until a shape has been tuned (see
+   gemm_tuner.hpp) or loaded from the on-disk cache. */
+namespace gemm {
+
+/* out is m x n, a is m x k, b is k x n. element_size tells float and double
+   entries of the same shape apart. */
+struct Shape {
+  int m = 0;
+  int n = 0;
+  int k = 0;
+  int element_size = 0;
+
+  bool operator<(const Shape& other) const {
+    return std::tie(m, n, k, element_size) < std::tie(other.m, other.n, other.k, other.element_size);
+  }
+  bool operator==(const Shape& other) const {
+    return m == other.m && n == other.n && k == other.k && element_size == other.element_size;
+  }
+};
+
+/* Rows of out are split into mc-row blocks shared out over `threads`; each
+   thread walks nc-column by kc-deep panels of b (packed contiguously) and
+   updates mr rows of out per pass over a panel row. mr == 0 selects the
+   reference kernel, which is what the tuner records when blocking loses.
+   `threads` is a hint measured in isolation: multiply() runs on the calling
+   thread alone when it is already inside a parallel::Region. */
+struct Config {
+  int mc = 64;
+  int nc = 256;
+  int kc = 256;
+  int mr = 4;
+  int threads = 1;
+
+  bool isReference() const { return mr == 0; }
+  bool operator==(const Config& other) const {
+    return mc == other.mc && nc == other.nc && kc == other.kc && mr == other.mr && threads == other.threads;
+  }
+};
+
+/* Blocked kernel over raw strided operands; out must have unit column
+   stride. Every out(i, j) accumulates a(i, p) * b(p, j) for p = 0..k-1 in
+   ascending order, exactly like the reference kernel, so results are
+   bit-identical whatever the config. */
+template<typename T>
+void multiply(const Config& config, int m, int n, int k,
+              const T* a, std::ptrdiff_t a_rs, std::ptrdiff_t a_cs,
+              const T* b, std::ptrdiff_t b_rs, std::ptrdiff_t b_cs,
+              T* out, std::ptrdiff_t out_rs);
+
+namespace detail {
+
+constexpr std::size_t kReaderSlots = 64;
+
+/* The calling thread's reader slot in every Table, handed out round robin. */
+inline std::size_t readerSlot() {
+  static std::atomic<std::size_t> next{0};
+  thread_local const std::size_t slot = next.fetch_add(1, std::memory_order_relaxed) % kReaderSlots;
+  return slot;
+}
+
+}  // namespace detail
+
+/* Tuned configs by shape. Thread safe. Writers (set, load, clear) take a
+   mutex and publish an immutable snapshot of the table through an atomic
+   pointer; find() only reads the current snapshot, so the per-GEMM lookup
+   takes no lock. While reading, find() counts itself in its thread's reader
+   slot (one cache line each, unshared up to kReaderSlots threads). A
+   publish waits until every slot has been idle once, which rules out a
+   reader of the replaced snapshot, and then frees it, so memory stays at
+   one snapshot however often the table changes. */
+class Table {
+public:
+  Table() = default;
+  ~Table();
+
+  Table(const Table&) = delete;
+  Table& operator=(const Table&) = delete;
+
+  std::optional<Config> find(const Shape& shape) const;
+  void set(const Shape& shape, const Config& config);
+  /* Records several shapes with a single publish. */
+  void set(const std::vector<std::pair<Shape, Config>>& configs);
+  std::size_t size() const;
+  void clear();
+
+  /* Text cache, one line per (CPU model, shape). load() keeps only entries
+     recorded for this machine's CPU model; save() rewrites the file with this
+     table's entries and leaves other CPUs' lines alone. Both return false on
+     I/O failure. */
+  bool load(const std::string& path);
+  bool save(const std::string& path) const;
+
+  /* Loads defaultCachePath() once per process. */
+  void loadDefaultCache();
+
+private:
+  using Snapshot = std::map<Shape, Config>;
+
+  struct alignas(64) ReaderSlot {
+    std::atomic<int> active{0};
+  };
+
+  /* Publishes a copy of entries_ and frees the one it replaces; mutex_
+     must be held. */
+  void publishLocked();
+
+  mutable std::mutex mutex_;
+  Snapshot entries_;
+  std::atomic<const Snapshot*> current_{nullptr};  // nullptr while empty
+  mutable ReaderSlot readers_[detail::kReaderSlots];
+  bool default_cache_loaded_ = false;
+};
+
+Table& table();
+
+/* CPU model string from /proc/cpuinfo ("unknown" if unavailable). */
+std::string cpuModel();
+
+/* $NN_GEMM_CACHE if set, else $XDG_CACHE_HOME/neuralnet/gemm.cache, else
+   ~/.cache/neuralnet/gemm.cache. */
+std::string defaultCachePath();
+
+/* Implementations */
+namespace detail {
+
+/* MR rows of out += a(rows, p0..p1) * panel, where the panel holds rows
+   p0..p1 of b restricted to nb columns, packed with leading dimension nb. */
+template<typename T, int MR>
+void microKernel(int nb, int p0, int p1, const T* a, std::ptrdiff_t a_rs, std::ptrdiff_t a_cs,
+                 const T* panel, T* out, std::ptrdiff_t out_rs) {
+  T* rows[MR];
+  for (int r = 0; r < MR; ++r) rows[r] = out + r * out_rs;
+
+  for (int p = p0; p < p1; ++p) {
+    T a_p[MR];
+    for (int r = 0; r < MR; ++r) a_p[r] = a[r * a_rs + static_cast<std::ptrdiff_t>(p) * a_cs];
+    const T* b_row = panel + static_cast<std::ptrdiff_t>(p - p0) * nb;
+    for (int j = 0; j < nb; ++j) {
+      const T b_pj = b_row[j];
+      for (int r = 0; r < MR; ++r) rows[r][j] += a_p[r] * b_pj;
+    }
+  }
+}
+
+template<typename T>
+void rowBlock(int mr, int rows, int nb, int p0, int p1, const T* a, std::ptrdiff_t a_rs, std::ptrdiff_t a_cs,
+              const T* panel, T* out, std::ptrdiff_t out_rs) {
+  int i = 0;
+  switch (mr) {
+    case 8:
+      for (; i + 8 <= rows; i += 8) microKernel<T, 8>(nb, p0, p1, a + i * a_rs, a_rs, a_cs, panel, out + i * out_rs, out_rs);
+      break;
+    case 4:
+      for (; i + 4 <= rows; i += 4) microKernel<T, 4>(nb, p0, p1, a + i * a_rs, a_rs, a_cs, panel, out + i * out_rs, out_rs);
+      break;
+    case 2:
+      for (; i + 2 <= rows; i += 2) microKernel<T, 2>(nb, p0, p1, a + i * a_rs, a_rs, a_cs, panel, out + i * out_rs, out_rs);
+      break;
+    default:
+      break;
+  }
+  for (; i < rows; ++i) {
+    microKernel<T, 1>(nb, p0, p1, a + i * a_rs, a_rs, a_cs, panel, out + i * out_rs, out_rs);
+  }
+}
+
+}  // namespace detail
+
+template<typename T>
+void multiply(const Config& config, int m, int n, int k,
+              const T* a, std::ptrdiff_t a_rs, std::ptrdiff_t a_cs,
+              const T* b, std::ptrdiff_t b_rs, std::ptrdiff_t b_cs,
+              T* out, std::ptrdiff_t out_rs) {
+  const int mc = std::max(config.mc, 1);
+  const int nc = std::max(config.nc, 1);
+  const int kc = std::max(config.kc, 1);
+  const std::size_t row_blocks = (static_cast<std::size_t>(m) + mc - 1) / mc;
+  const int threads = parallel::inRegion() ? 1 : config.threads;
+
+  parallel::forRange(row_blocks, threads, [&](std::size_t first, std::size_t last) {
+    const int i0 = static_cast<int>(first) * mc;
+    const int i1 = std::min(m, static_cast<int>(last) * mc);
+    for (int i = i0; i < i1; ++i) {
+      std::fill(out + i * out_rs, out + i * out_rs + n, T{});
+    }
+
+    std::vector<T, AlignedAllocator<T>> panel(static_cast<std::size_t>(std::min(kc, k)) * std::min(nc, n));
+    for (int j0 = 0; j0 < n; j0 += nc) {
+      const int nb = std::min(nc, n - j0);
+      for (int p0 = 0; p0 < k; p0 += kc) {
+        const int p1 = std::min(k, p0 + kc);
+        for (int p = p0; p < p1; ++p) {
+          const T* b_row = b + p * b_rs + j0 * b_cs;
+          T* dst = panel.data() + static_cast<std::ptrdiff_t>(p - p0) * nb;
+          for (int j = 0; j < nb; ++j) dst[j] = b_row[j * b_cs];
+        }
+        for (int ib = i0; ib < i1; ib += mc) {
+          const int rows = std::min(mc, i1 - ib);
+          detail::rowBlock<T>(config.mr, rows, nb, p0, p1, a + ib * a_rs, a_rs, a_cs,
+                              panel.data(), out + ib * out_rs + j0, out_rs);
+        }
+      }
+    }
+  });
+}
+
+inline Table::~Table() {
+  delete current_.load();
+}
+
+inline std::optional<Config> Table::find(const Shape& shape) const {
+  if (!current_.load(std::memory_order_acquire)) {
+    return std::nullopt;  // nothing tuned: no snapshot to protect
+  }
+
+  /* Both operations are sequentially consistent: a publish that finds this
+     slot idle has already swapped current_, so the load below sees the new
+     snapshot rather than the one being freed. */
+  std::atomic<int>& active = readers_[detail::readerSlot()].active;
+  active.fetch_add(1);
+  std::optional<Config> config;
+  if (const Snapshot* snapshot = current_.load()) {
+    auto it = snapshot->find(shape);
+    if (it != snapshot->end()) {
+      config = it->second;
+    }
+  }
+  active.fetch_sub(1, std::memory_order_release);
+  return config;
+}
+
+inline void Table::publishLocked() {
+  const Snapshot* next = entries_.empty() ? nullptr : new Snapshot(entries_);
+  const Snapshot* old = current_.exchange(next);
+  if (!old) {
+    return;
+  }
+  /* Lookups are a map search, so each slot goes idle almost at once. */
+  for (const ReaderSlot& slot : readers_) {
+    while (slot.active.load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+  delete old;
+}
+
+inline void Table::set(const Shape& shape, const Config& config) {
+  set(std::vector<std::pair<Shape, Config>>{{shape, config}});
+}
+
+inline void Table::set(const std::vector<std::pair<Shape, Config>>& configs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool changed = false;
+  for (const auto& [shape, config] : configs) {
+    auto [it, inserted] = entries_.emplace(shape, config);
+    if (!inserted && !(it->second == config)) {
+      it->second = config;
+      inserted = true;
+    }
+    changed |= inserted;
+  }
+  if (changed) {
+    publishLocked();
+  }
+}
+
+inline std::size_t Table::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+inline void Table::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  publishLocked();
+}
+
+inline Table& table() {
+  static Table instance;
+  return instance;
+}
+
+}  // namespace gemm
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef GEMM_TUNER_H
+#define GEMM_TUNER_H
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "gemm.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+
+namespace gemm {
+
+struct TuneOptions {
+  int max_threads = 0;         // largest thread split tried; <= 0 uses every core
+  double min_seconds = 0.01;   // time budget per candidate (best of the runs is kept)
+  bool retune = false;         // re-measure shapes already in the table
+};
+
+struct TuneResult {
+  Shape shape;
+  Config config;
+  double seconds = 0.0;            // best time of the chosen config
+  double reference_seconds = 0.0;  // best time of the reference kernel
+  bool cached = false;             // taken from the table, nothing measured
+
+  double gflops() const {
+    return seconds > 0.0 ? 2.0 * shape.m * shape.n * shape.k / seconds * 1e-9 : 0.0;
+  }
+};
+
+/* Benchmarks candidate configs for one shape on random operands and returns
+   the fastest, or a reference config (mr == 0) when no blocking beats the
+   plain kernel. Coordinate descent: starting from the default config it
+   sweeps mr, kc and nc, then the thread split and mc, keeping the best value
+   of each before moving on. Does not touch the table. */
+template<typename T>
+TuneResult tune(const Shape& shape, const TuneOptions& options = TuneOptions());
+
+/* Implementations */
+namespace detail {
+
+template<typename Fn>
+double bestSeconds(double min_seconds, Fn&& fn) {
+  using clock = std::chrono::steady_clock;
+  double best = 0.0;
+  double total = 0.0;
+  for (int run = 0; run < 3 || total < min_seconds; ++run) {
+    auto start = clock::now();
+    fn();
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    best = run == 0 ? elapsed : std::min(best, elapsed);
+    total += elapsed;
+  }
+  return best;
+}
+
+/* Candidate values for one block size, clamped to the extent of the shape
+   and deduplicated. */
+inline std::vector<int> blockCandidates(std::vector<int> values, int extent) {
+  for (int& value : values) value = std::max(1, std::min(value, extent));
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  return values;
+}
+
+}  // namespace detail
+
+template<typename T>
+TuneResult tune(const Shape& shape, const TuneOptions& options) {
+  Matrix<T> a(shape.m, shape.k);
+  Matrix<T> b(shape.k, shape.n);
+  Matrix<T> out(shape.m, shape.n);
+  a.fillRandom(T(-1), T(1), rng::Stream{1, 0});
+  b.fillRandom(T(-1), T(1), rng::Stream{1, 1});
+
+  auto measure = [&](const Config& config) {
+    return detail::bestSeconds(options.min_seconds, [&] {
+      gemm::multiply<T>(config, shape.m, shape.n, shape.k, a.data(), shape.k, 1,
+                        b.data(), shape.n, 1, out.data(), shape.n);
+    });
+  };
+
+  TuneResult result;
+  result.shape = shape;
+  result.reference_seconds = detail::bestSeconds(options.min_seconds, [&] {
+    ::detail::matMulReference<T>(a.view(), b.view(), out.view());
+  });
+
+  Config best;
+  best.mc = std::min(best.mc, shape.m);
+  best.nc = std::min(best.nc, shape.n);
+  best.kc = std::min(best.kc, shape.k);
+  double best_seconds = measure(best);
+
+  auto sweep = [&](int Config::*field, const std::vector<int>& values) {
+    for (int value : values) {
+      if (best.*field == value) continue;
+      Config candidate = best;
+      candidate.*field = value;
+      double seconds = measure(candidate);
+      if (seconds < best_seconds) {
+        best = candidate;
+        best_seconds = seconds;
+      }
+    }
+  };
+
+  sweep(&Config::mr, {1, 2, 4, 8});
+  sweep(&Config::kc, detail::blockCandidates({64, 128, 256, 512, shape.k}, shape.k));
+  sweep(&Config::nc, detail::blockCandidates({64, 256, 1024, shape.n}, shape.n));
+
+  /* Threads share out mc-row blocks, so the split and mc are swept twice. */
+  std::vector<int> threads;
+  int max_threads = parallel::resolveThreads(options.max_threads);
+  for (int t = 1; t < max_threads; t *= 2) threads.push_back(t);
+  threads.push_back(max_threads);
+  std::vector<int> row_blocks = detail::blockCandidates({16, 32, 64, 128, 256}, shape.m);
+  sweep(&Config::threads, threads);
+  sweep(&Config::mc, row_blocks);
+  sweep(&Config::threads, threads);
+
+  if (best_seconds < result.reference_seconds) {
+    result.config = best;
+    result.seconds = best_seconds;
+  } else {
+    result.config = Config{0, 0, 0, 0, 1};
+    result.seconds = result.reference_seconds;
+  }
+  return result;
+}
+
+}  // namespace gemm
+
+#endif
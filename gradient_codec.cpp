@@ -0,0 +1,211 @@
+#include "gradient_codec.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+namespace distributed {
+
+Compression compressionFromString(const std::string& name) {
+  if (name == "none") return Compression::NONE;
+  if (name == "fp16") return Compression::FP16;
+  if (name == "topk") return Compression::TOP_K;
+  throw std::runtime_error("Unknown compression: " + name + " (expected none, fp16 or topk)");
+}
+
+const char* compressionName(Compression compression) {
+  switch (compression) {
+    case Compression::NONE: return "none";
+    case Compression::FP16: return "fp16";
+    case Compression::TOP_K: return "topk";
+  }
+  return "?";
+}
+
+uint16_t floatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint32_t sign = (bits >> 16) & 0x8000u;
+  const uint32_t abs = bits & 0x7FFFFFFFu;
+
+  if (abs >= 0x7F800000u) {  // Inf / NaN (keep NaN quiet)
+    return static_cast<uint16_t>(sign | 0x7C00u | (abs > 0x7F800000u ? 0x200u : 0u));
+  }
+  if (abs >= 0x477FF000u) {  // rounds to a value beyond the half range
+    return static_cast<uint16_t>(sign | 0x7C00u);
+  }
+  if (abs < 0x38800000u) {  // half subnormal or zero
+    if (abs < 0x33000000u) return static_cast<uint16_t>(sign);
+    const uint32_t exponent = abs >> 23;
+    const uint32_t mantissa = (abs & 0x7FFFFFu) | 0x800000u;
+    const uint32_t shift = 126 - exponent;  // 14..24
+    uint32_t half = mantissa >> shift;
+    const uint32_t rest = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half & 1u))) ++half;
+    return static_cast<uint16_t>(sign | half);
+  }
+
+  uint32_t half = ((abs - 0x38000000u) >> 13);
+  const uint32_t rest = abs & 0x1FFFu;
+  if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) ++half;
+  return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value) {
+  const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+  uint32_t exponent = (value >> 10) & 0x1Fu;
+  uint32_t mantissa = value & 0x3FFu;
+  uint32_t bits;
+
+  if (exponent == 0x1Fu) {
+    bits = sign | 0x7F800000u | (mantissa << 13);
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  } else if (mantissa == 0) {
+    bits = sign;
+  } else {  // subnormal: normalize
+    exponent = 113;
+    while ((mantissa & 0x400u) == 0) {
+      mantissa <<= 1;
+      --exponent;
+    }
+    bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+  }
+
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+void encode(const float* values, std::size_t count, Compression compression, double top_k_ratio,
+            std::vector<char>& out) {
+  CodecHeader header{compression, static_cast<uint32_t>(count), 0, 0};
+  std::size_t payload = 0;
+
+  std::vector<uint32_t> indices;
+  switch (compression) {
+    case Compression::NONE:
+      payload = count * sizeof(float);
+      break;
+    case Compression::FP16:
+      payload = count * sizeof(uint16_t);
+      break;
+    case Compression::TOP_K: {
+      std::size_t keep = std::min(count, std::max<std::size_t>(1, static_cast<std::size_t>(top_k_ratio * count)));
+      indices.resize(count);
+      std::iota(indices.begin(), indices.end(), 0u);
+      auto larger = [values](uint32_t a, uint32_t b) {
+        float x = std::fabs(values[a]);
+        float y = std::fabs(values[b]);
+        return x > y || (x == y && a < b);
+      };
+      std::nth_element(indices.begin(), indices.begin() + keep, indices.end(), larger);
+      indices.resize(keep);
+      std::sort(indices.begin(), indices.end());
+      header.entries = static_cast<uint32_t>(keep);
+      payload = keep * (sizeof(uint32_t) + sizeof(float));
+      break;
+    }
+  }
+
+  out.resize(sizeof(header) + payload);
+  std::memcpy(out.data(), &header, sizeof(header));
+  char* cursor = out.data() + sizeof(header);
+
+  switch (compression) {
+    case Compression::NONE:
+      std::memcpy(cursor, values, payload);
+      break;
+    case Compression::FP16:
+      for (std::size_t i = 0; i < count; ++i) {
+        uint16_t half = floatToHalf(values[i]);
+        std::memcpy(cursor + i * sizeof(half), &half, sizeof(half));
+      }
+      break;
+    case Compression::TOP_K: {
+      std::memcpy(cursor, indices.data(), indices.size() * sizeof(uint32_t));
+      char* value_bytes = cursor + indices.size() * sizeof(uint32_t);
+      for (std::size_t i = 0; i < indices.size(); ++i) {
+        std::memcpy(value_bytes + i * sizeof(float), &values[indices[i]], sizeof(float));
+      }
+      break;
+    }
+  }
+}
+
+void decodeAdd(const char* data, std::size_t size, float* accumulator, std::size_t count) {
+  CodecHeader header;
+  if (size < sizeof(header)) {
+    throw std::runtime_error("Gradient buffer is truncated.");
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (header.count != count) {
+    throw std::runtime_error("Gradient buffer has " + std::to_string(header.count) + " values, expected " +
+                             std::to_string(count));
+  }
+  const char* payload = data + sizeof(header);
+  const std::size_t payload_size = size - sizeof(header);
+
+  switch (header.codec) {
+    case Compression::NONE: {
+      if (payload_size != count * sizeof(float)) break;
+      for (std::size_t i = 0; i < count; ++i) {
+        float value;
+        std::memcpy(&value, payload + i * sizeof(float), sizeof(value));
+        accumulator[i] += value;
+      }
+      return;
+    }
+    case Compression::FP16: {
+      if (payload_size != count * sizeof(uint16_t)) break;
+      for (std::size_t i = 0; i < count; ++i) {
+        uint16_t half;
+        std::memcpy(&half, payload + i * sizeof(half), sizeof(half));
+        accumulator[i] += halfToFloat(half);
+      }
+      return;
+    }
+    case Compression::TOP_K: {
+      const std::size_t entries = header.entries;
+      if (payload_size != entries * (sizeof(uint32_t) + sizeof(float))) break;
+      const char* values = payload + entries * sizeof(uint32_t);
+      for (std::size_t i = 0; i < entries; ++i) {
+        uint32_t index;
+        float value;
+        std::memcpy(&index, payload + i * sizeof(index), sizeof(index));
+        std::memcpy(&value, values + i * sizeof(value), sizeof(value));
+        if (index >= count) {
+          throw std::runtime_error("Gradient buffer index out of range.");
+        }
+        accumulator[index] += value;
+      }
+      return;
+    }
+  }
+  throw std::runtime_error("Malformed gradient buffer.");
+}
+
+void ErrorFeedback::encode(std::vector<float>& gradient, Compression compression, double top_k_ratio,
+                           std::vector<char>& out) {
+  if (compression == Compression::NONE) {
+    distributed::encode(gradient.data(), gradient.size(), compression, top_k_ratio, out);
+    return;
+  }
+
+  residual_.resize(gradient.size(), 0.0f);
+  for (std::size_t i = 0; i < gradient.size(); ++i) {
+    gradient[i] += residual_[i];
+  }
+  distributed::encode(gradient.data(), gradient.size(), compression, top_k_ratio, out);
+
+  decoded_.assign(gradient.size(), 0.0f);
+  decodeAdd(out.data(), out.size(), decoded_.data(), decoded_.size());
+  for (std::size_t i = 0; i < gradient.size(); ++i) {
+    residual_[i] = gradient[i] - decoded_[i];
+  }
+}
+
+}  // namespace distributed
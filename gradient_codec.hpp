@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Gradient compression for distributed training.
+
+   An encoded buffer is a CodecHeader followed by the payload:
+     NONE  count float32 values
+     FP16  count IEEE half-precision values (round to nearest even)
+     TOP_K `entries` uint32 indices, then `entries` float32 values; every
+           other element is zero
+   Buffers are native-endian, like the rest of the wire formats here. */
+namespace distributed {
+
+enum class Compression : uint32_t {
+  NONE = 0,
+  FP16 = 1,
+  TOP_K = 2,
+};
+
+struct CodecHeader {
+  Compression codec;
+  uint32_t count;    // dense length of the vector
+  uint32_t entries;  // TOP_K: number of (index, value) pairs
+  uint32_t reserved;
+};
+
+Compression compressionFromString(const std::string& name);  // "none", "fp16", "topk"
+const char* compressionName(Compression compression);
+
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+/* Encodes values[0..count) into out (replacing its contents). For TOP_K,
+   keeps the max(1, ratio * count) entries of largest magnitude. */
+void encode(const float* values, std::size_t count, Compression compression, double top_k_ratio,
+            std::vector<char>& out);
+
+/* Adds the decoded vector to accumulator[0..count); throws if the buffer is
+   malformed or its length differs from count. */
+void decodeAdd(const char* data, std::size_t size, float* accumulator, std::size_t count);
+
+/* Lossy codecs with error feedback: each worker keeps what compression
+   dropped and adds it back into the next step's gradient, so small
+   components are delayed rather than lost. */
+class ErrorFeedback {
+public:
+  /* Adds the carried residual to gradient, encodes it into out and keeps
+     gradient - decode(out) as the residual for next time. */
+  void encode(std::vector<float>& gradient, Compression compression, double top_k_ratio,
+              std::vector<char>& out);
+
+private:
+  std::vector<float> residual_;
+  std::vector<float> decoded_;
+};
+
+}  // namespace distributed
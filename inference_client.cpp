@@ -0,0 +1,77 @@
+#include "inference_client.hpp"
+
+#include <stdexcept>
+
+#include "inference_protocol.hpp"
+#include "socket_io.hpp"
+
+InferenceClient::InferenceClient(const std::string& socket_path) {
+  using namespace inference;
+
+  fd_ = socket_io::connectUnix(socket_path);
+  try {
+    Request hello{kProtocolMagic, Op::HELLO, 0, 0};
+    socket_io::sendAll(fd_, &hello, sizeof(hello));
+
+    HelloReply reply;
+    if (!socket_io::recvAll(fd_, &reply, sizeof(reply)) || reply.magic != kProtocolMagic) {
+      throw std::runtime_error("Inference server sent an invalid handshake.");
+    }
+    if (reply.status != Status::OK) {
+      throw std::runtime_error("Inference server has no free slot.");
+    }
+
+    input_size_ = static_cast<int>(reply.input_size);
+    output_size_ = static_cast<int>(reply.output_size);
+    max_batch_ = static_cast<int>(reply.max_batch);
+
+    reply.slots_name[kNameLength - 1] = '\0';
+    slots_ = SharedMemory::attach(reply.slots_name, true);
+    char* base = static_cast<char*>(slots_.data()) + reply.slot_stride * reply.slot;
+    input_ = reinterpret_cast<float*>(base);
+    output_ = reinterpret_cast<float*>(base + slotRegionBytes(reply.input_size, reply.max_batch));
+  } catch (...) {
+    socket_io::closeFd(fd_);
+    throw;
+  }
+}
+
+InferenceClient::~InferenceClient() {
+  socket_io::closeFd(fd_);
+}
+
+MatrixView<float> InferenceClient::input(int batch) {
+  if (batch < 1 || batch > max_batch_) {
+    throw std::runtime_error("Batch size outside the server's slot capacity.");
+  }
+  return MatrixView<float>(input_, input_size_, batch);
+}
+
+MatrixView<const float> InferenceClient::predict(int batch) {
+  using namespace inference;
+
+  Request request{kProtocolMagic, Op::PREDICT, static_cast<uint32_t>(batch), ++sequence_};
+  socket_io::sendAll(fd_, &request, sizeof(request));
+
+  Response response;
+  if (!socket_io::recvAll(fd_, &response, sizeof(response))) {
+    throw std::runtime_error("Inference server closed the connection.");
+  }
+  if (response.status != Status::OK || response.sequence != sequence_) {
+    throw std::runtime_error("Inference request rejected by server.");
+  }
+  return MatrixView<const float>(output_, output_size_, batch);
+}
+
+Matrix<float> InferenceClient::predict(MatrixView<const float> input) {
+  if (input.rows() != input_size_) {
+    throw std::runtime_error("Input has the wrong number of features for this model.");
+  }
+  MatrixView<float> slot = this->input(input.cols());
+  for (int r = 0; r < input.rows(); ++r) {
+    for (int c = 0; c < input.cols(); ++c) {
+      slot(r, c) = input(r, c);
+    }
+  }
+  return Matrix<float>(predict(input.cols()));
+}
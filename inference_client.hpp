@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "matrix.hpp"
+#include "shared_memory.hpp"
+
+/* Client side of InferenceServer. Connecting reserves one shared-memory slot
+   on the server. The zero-copy path is:
+
+     MatrixView<float> in = client.input(batch);  // write features here
+     ...fill in...
+     MatrixView<const float> out = client.predict(batch);
+
+   `out` points into the slot and stays valid until the next request. */
+class InferenceClient {
+public:
+  explicit InferenceClient(const std::string& socket_path);
+  ~InferenceClient();
+
+  InferenceClient(const InferenceClient&) = delete;
+  InferenceClient& operator=(const InferenceClient&) = delete;
+
+  int inputSize() const { return input_size_; }
+  int outputSize() const { return output_size_; }
+  int maxBatch() const { return max_batch_; }
+
+  /* Writable input_size x batch view into this client's slot. */
+  MatrixView<float> input(int batch);
+
+  /* Runs the model on the first `batch` columns currently in the slot. */
+  MatrixView<const float> predict(int batch);
+
+  /* Convenience wrapper that copies `input` into the slot first. */
+  Matrix<float> predict(MatrixView<const float> input);
+
+private:
+  int fd_ = -1;
+  SharedMemory slots_;
+  float* input_ = nullptr;
+  float* output_ = nullptr;
+  int input_size_ = 0;
+  int output_size_ = 0;
+  int max_batch_ = 0;
+  uint32_t sequence_ = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Wire protocol between InferenceServer and InferenceClient.
+
+   Every message is a fixed-size, native-endian struct; tensors never travel
+   over the socket. On connect the client sends a Request with op HELLO and
+   receives a HelloReply naming the shared-memory objects holding the model
+   and the slot table, plus the index of the slot reserved for it. Afterwards
+   the client writes a features x batch input into its slot, sends a PREDICT
+   Request and reads a Response; the outputs x batch result is then waiting in
+   the same slot. */
+namespace inference {
+
+constexpr uint32_t kProtocolMagic = 0x314E4E53;  // "SNN1"
+constexpr std::size_t kNameLength = 64;
+
+enum class Op : uint32_t {
+  HELLO = 1,
+  PREDICT = 2,
+};
+
+enum class Status : uint32_t {
+  OK = 0,
+  BAD_REQUEST = 1,
+  NO_FREE_SLOT = 2,
+};
+
+struct Request {
+  uint32_t magic;
+  Op op;
+  uint32_t batch;     // PREDICT: number of columns in the slot's input
+  uint32_t sequence;  // echoed back in the response
+};
+
+struct Response {
+  Status status;
+  uint32_t batch;
+  uint32_t sequence;
+  uint32_t reserved;
+};
+
+struct HelloReply {
+  uint32_t magic;
+  Status status;
+  uint32_t slot;
+  uint32_t max_batch;
+  uint32_t input_size;
+  uint32_t output_size;
+  uint64_t slot_stride;  // bytes between consecutive slots
+  char model_name[kNameLength];
+  char slots_name[kNameLength];
+};
+
+/* Layout of one slot: the input region (input_size x max_batch floats), then
+   the output region, each padded to 64 bytes. A batch of b samples occupies
+   the first input_size * b (output_size * b) floats as a dense row-major
+   matrix with b columns. */
+inline std::size_t slotRegionBytes(uint32_t rows, uint32_t max_batch) {
+  std::size_t bytes = static_cast<std::size_t>(rows) * max_batch * sizeof(float);
+  return (bytes + 63) / 64 * 64;
+}
+
+inline std::size_t slotStride(uint32_t input_size, uint32_t output_size, uint32_t max_batch) {
+  return slotRegionBytes(input_size, max_batch) + slotRegionBytes(output_size, max_batch);
+}
+
+}  // namespace inference
@@ -0,0 +1,201 @@
+#include "inference_server.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "inference_protocol.hpp"
+#include "neuralnetwork.hpp"
+#include "parallel.hpp"
+#include "socket_io.hpp"
+
+namespace {
+
+std::string uniqueShmName(const char* kind) {
+  static std::atomic<unsigned> counter{0};
+  return "/nncpp-" + std::string(kind) + "-" + std::to_string(::getpid()) + "-" +
+         std::to_string(counter.fetch_add(1));
+}
+
+SharedModel publishModel(const std::string& model_path) {
+  NeuralNet<float> net;
+  net.load(model_path);
+  if (net.weights().empty()) {
+    throw std::runtime_error("Could not load model: " + model_path);
+  }
+  return SharedModel::publish(uniqueShmName("model"), net);
+}
+
+void copyName(char (&dst)[inference::kNameLength], const std::string& src) {
+  if (src.size() >= inference::kNameLength) {
+    throw std::runtime_error("Shared memory name too long: " + src);
+  }
+  std::memcpy(dst, src.c_str(), src.size() + 1);
+}
+
+}  // namespace
+
+InferenceServer::InferenceServer(const std::string& model_path, const std::string& socket_path,
+                                 InferenceServerOptions options)
+  : socket_path_(socket_path), options_(options), model_(publishModel(model_path)) {
+  if (options_.max_clients < 1 || options_.max_batch < 1) {
+    throw std::runtime_error("InferenceServer needs max_clients >= 1 and max_batch >= 1.");
+  }
+
+  slot_stride_ = inference::slotStride(model_.inputSize(), model_.outputSize(), options_.max_batch);
+  slots_ = SharedMemory::create(uniqueShmName("slots"), slot_stride_ * options_.max_clients);
+  slot_in_use_.assign(options_.max_clients, false);
+
+  listen_fd_ = socket_io::listenUnix(socket_path_);
+}
+
+InferenceServer::~InferenceServer() {
+  stop();
+  socket_io::closeFd(listen_fd_);
+  ::unlink(socket_path_.c_str());
+}
+
+void InferenceServer::stop() {
+  stop_requested_.store(true);
+}
+
+void InferenceServer::run() {
+  std::cout << "Serving " << model_.name() << " on " << socket_path_ << "\n";
+
+  /* poll() with a timeout so stop() is noticed without closing the socket
+     from another thread. */
+  while (!stop_requested_.load()) {
+    pollfd pfd{listen_fd_, POLLIN, 0};
+    int ready = ::poll(&pfd, 1, 100);
+    if (ready < 0 && errno != EINTR) {
+      throw std::runtime_error(std::string("poll(): ") + std::strerror(errno));
+    }
+    reapFinishedWorkers();
+    if (ready <= 0) {
+      continue;
+    }
+
+    int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    client_fds_.insert(fd);
+    workers_.emplace_back(&InferenceServer::serveClient, this, fd);
+  }
+
+  /* Wake every worker blocked in recv() and wait for them to finish. */
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int fd : client_fds_) {
+      ::shutdown(fd, SHUT_RDWR);
+    }
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+/* Joins the threads of clients that have disconnected, so a long-running
+   daemon does not accumulate one exited thread per past connection. */
+void InferenceServer::reapFinishedWorkers() {
+  std::vector<std::thread> done;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::thread::id id : finished_workers_) {
+      for (auto it = workers_.begin(); it != workers_.end(); ++it) {
+        if (it->get_id() == id) {
+          done.push_back(std::move(*it));
+          workers_.erase(it);
+          break;
+        }
+      }
+    }
+    finished_workers_.clear();
+  }
+  for (auto& worker : done) {
+    worker.join();
+  }
+}
+
+int InferenceServer::acquireSlot() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::size_t i = 0; i < slot_in_use_.size(); ++i) {
+    if (!slot_in_use_[i]) {
+      slot_in_use_[i] = true;
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void InferenceServer::releaseSlot(int slot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  slot_in_use_[slot] = false;
+}
+
+void InferenceServer::serveClient(int fd) {
+  parallel::Region region;  // one thread per client already
+  using namespace inference;
+
+  int slot = -1;
+  try {
+    Request hello;
+    if (socket_io::recvAll(fd, &hello, sizeof(hello)) &&
+        hello.magic == kProtocolMagic && hello.op == Op::HELLO) {
+      slot = acquireSlot();
+
+      HelloReply reply{};
+      reply.magic = kProtocolMagic;
+      reply.status = slot >= 0 ? Status::OK : Status::NO_FREE_SLOT;
+      reply.slot = static_cast<uint32_t>(slot);
+      reply.max_batch = static_cast<uint32_t>(options_.max_batch);
+      reply.input_size = static_cast<uint32_t>(model_.inputSize());
+      reply.output_size = static_cast<uint32_t>(model_.outputSize());
+      reply.slot_stride = slot_stride_;
+      copyName(reply.model_name, model_.name());
+      copyName(reply.slots_name, slots_.name());
+      socket_io::sendAll(fd, &reply, sizeof(reply));
+    }
+
+    if (slot >= 0) {
+      char* base = static_cast<char*>(slots_.data()) + slot_stride_ * slot;
+      const float* input = reinterpret_cast<const float*>(base);
+      float* output = reinterpret_cast<float*>(
+          base + slotRegionBytes(model_.inputSize(), options_.max_batch));
+
+      Request request;
+      while (socket_io::recvAll(fd, &request, sizeof(request))) {
+        Response response{Status::OK, request.batch, request.sequence, 0};
+        int batch = static_cast<int>(request.batch);
+
+        if (request.magic != kProtocolMagic || request.op != Op::PREDICT ||
+            batch < 1 || batch > options_.max_batch) {
+          response.status = Status::BAD_REQUEST;
+        } else {
+          model_.predictInto(MatrixView<const float>(input, model_.inputSize(), batch),
+                             MatrixView<float>(output, model_.outputSize(), batch));
+        }
+        socket_io::sendAll(fd, &response, sizeof(response));
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Inference client error: " << e.what() << "\n";
+  }
+
+  if (slot >= 0) {
+    releaseSlot(slot);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  client_fds_.erase(fd);
+  socket_io::closeFd(fd);
+  finished_workers_.push_back(std::this_thread::get_id());
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shared_memory.hpp"
+#include "shared_model.hpp"
+
+struct InferenceServerOptions {
+  int max_clients = 64;  // one shared-memory slot per connected client
+  int max_batch = 256;   // largest batch a client may submit
+};
+
+/* Local inference daemon. Loads an NNB1 model once, publishes it to shared
+   memory (see SharedModel) and answers predict requests from other processes
+   over a Unix-domain socket using the protocol in inference_protocol.hpp.
+   Inputs and outputs are exchanged through per-client shared-memory slots,
+   so a request is a 16-byte message and the tensors are never copied through
+   the kernel. Each connection is served by its own thread. */
+class InferenceServer {
+public:
+  InferenceServer(const std::string& model_path, const std::string& socket_path,
+                  InferenceServerOptions options = InferenceServerOptions());
+  ~InferenceServer();
+
+  InferenceServer(const InferenceServer&) = delete;
+  InferenceServer& operator=(const InferenceServer&) = delete;
+
+  /* Accepts and serves clients until stop() is called. */
+  void run();
+
+  /* Safe to call from another thread or a signal handler. */
+  void stop();
+
+  const SharedModel& model() const { return model_; }
+
+private:
+  void serveClient(int fd);
+  void reapFinishedWorkers();
+  int acquireSlot();
+  void releaseSlot(int slot);
+
+  std::string socket_path_;
+  InferenceServerOptions options_;
+  SharedModel model_;
+  SharedMemory slots_;
+  std::size_t slot_stride_ = 0;
+
+  int listen_fd_ = -1;
+  std::atomic<bool> stop_requested_{false};
+
+  std::mutex mutex_;
+  std::vector<bool> slot_in_use_;
+  std::set<int> client_fds_;
+  std::vector<std::thread> workers_;
+  std::vector<std::thread::id> finished_workers_;
+};
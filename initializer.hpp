@@ -1,11 +1,26 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
+#include <string>
 #include <type_traits>
 #include "matrix.hpp"  // make sure Matrix<T> is declared here
+#include "random.hpp"
 
 namespace initializer {
 
+/* Where an initializer draws its numbers from. NeuralNet hands every layer
+   its own stream of the network seed, so weights are a function of
+   (seed, layer) only and the fill can be split across any number of threads. */
+struct Context {
+  rng::Stream stream;
+  int threads = 0;
+};
+
+inline Context layerContext(uint64_t seed, std::size_t layer, int threads) {
+  return Context{rng::Stream{seed, static_cast<uint64_t>(layer)}, threads};
+}
+
 enum class Type {
   UNIFORM,
   XAVIER,
@@ -14,29 +29,29 @@ enum class Type {
 };
 
 template<typename T>
-inline auto uniform = [](Matrix<T>& m, int /*in*/, int /*out*/) {
-    m.fillRandom(static_cast<T>(-0.5), static_cast<T>(0.5));
+inline auto uniform = [](Matrix<T>& m, int /*in*/, int /*out*/, const Context& ctx) {
+    m.fillRandom(static_cast<T>(-0.5), static_cast<T>(0.5), ctx.stream, ctx.threads);
 };
 
 template<typename T>
-inline auto xavier = [](Matrix<T>& m, int in, int out) {
+inline auto xavier = [](Matrix<T>& m, int in, int out, const Context& ctx) {
     T limit = std::sqrt(static_cast<T>(6.0) / (in + out));
-    m.fillRandom(-limit, limit);
+    m.fillRandom(-limit, limit, ctx.stream, ctx.threads);
 };
 
 template<typename T>
-inline auto he = [](Matrix<T>& m, int in, int /*out*/) {
+inline auto he = [](Matrix<T>& m, int in, int /*out*/, const Context& ctx) {
   if constexpr(std::is_floating_point<T>::value) {
     T stddev = std::sqrt(static_cast<T>(2.0) / in);
-    m.fillNormal(static_cast<T>(0.0), stddev);
+    m.fillNormal(static_cast<T>(0.0), stddev, ctx.stream, ctx.threads);
   } else {
     T limit = static_cast<T>(1);
-    m.fillRandom(-limit, limit);
+    m.fillRandom(-limit, limit, ctx.stream, ctx.threads);
   }
 };
 
 template<typename T>
-inline auto zeros = [](Matrix<T>& m, int /*in*/, int /*out*/) {
+inline auto zeros = [](Matrix<T>& m, int /*in*/, int /*out*/, const Context& /*ctx*/) {
     m.fill(static_cast<T>(0));
 };
 
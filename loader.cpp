@@ -4,6 +4,7 @@
 #include <utility>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 
 std::pair<std::vector<Matrix<float>>, std::vector<Matrix<float>>> generateXORDataset() {
     std::vector<Matrix<float>> inputs;
@@ -52,42 +53,60 @@ std::pair<std::vector<Matrix<float>>, std::vector<Matrix<float>>> generateXORDat
     return {inputs, targets};
 }
 
-std::pair<std::vector<Matrix<float>>, std::vector<Matrix<float>>> loadIrisDataset(const std::string& filename) {
-    std::vector<Matrix<float>> inputs;
-    std::vector<Matrix<float>> targets;
+namespace {
 
-    std::unordered_map<std::string, int> class_map = {
+/* Parses one "f0,f1,f2,f3,label" line. Returns false for malformed lines. */
+bool parseIrisLine(const std::string& line, float (&values)[4], int& class_index) {
+    static const std::unordered_map<std::string, int> class_map = {
         {"Iris-setosa", 0},
         {"Iris-versicolor", 1},
         {"Iris-virginica", 2}
     };
 
-    std::ifstream file(filename);
-    std::string line;
+    std::stringstream ss(line);
+    std::string item;
+    int count = 0;
 
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string item;
-        std::vector<float> values;
-
-        // Read 4 features
-        for (int i = 0; i < 4; ++i) {
-            if (!std::getline(ss, item, ',')) {
-                continue;
-            }
-
-            try {
-                values.push_back(std::stof(item));
-            } catch (const std::invalid_argument&) {
-                continue;
-            }
+    // Read 4 features
+    for (int i = 0; i < 4; ++i) {
+        if (!std::getline(ss, item, ',')) {
+            continue;
+        }
+
+        try {
+            values[count] = std::stof(item);
+            ++count;
+        } catch (const std::invalid_argument&) {
+            continue;
         }
+    }
+
+    // Read class label
+    std::string label;
+    std::getline(ss, label, ',');
+
+    if (count != 4) {
+        return false;
+    }
+
+    auto it = class_map.find(label);
+    class_index = it != class_map.end() ? it->second : 0;
+    return true;
+}
+
+}  // namespace
+
+std::pair<std::vector<Matrix<float>>, std::vector<Matrix<float>>> loadIrisDataset(const std::string& filename) {
+    std::vector<Matrix<float>> inputs;
+    std::vector<Matrix<float>> targets;
 
-        // Read class label
-        std::string label;
-        std::getline(ss, label, ',');
+    std::ifstream file(filename);
+    std::string line;
 
-        if (values.size() != 4) {
+    while (std::getline(file, line)) {
+        float values[4];
+        int class_index;
+        if (!parseIrisLine(line, values, class_index)) {
             continue;
         }
 
@@ -100,7 +119,6 @@ std::pair<std::vector<Matrix<float>>, std::vector<Matrix<float>>> loadIrisDatase
 
         // Create one-hot output matrix (3×1)
         Matrix<float> output(3, 1);
-        int class_index = class_map[label];
         output.set(class_index, 0, 1.0f);
 
         targets.push_back(output);
@@ -108,3 +126,34 @@ std::pair<std::vector<Matrix<float>>, std::vector<Matrix<float>>> loadIrisDatase
 
     return {inputs, targets};
 }
+
+Dataset loadIrisBatch(const std::string& filename) {
+    std::vector<float> features;
+    std::vector<int> labels;
+
+    std::ifstream file(filename);
+    std::string line;
+
+    while (std::getline(file, line)) {
+        float values[4];
+        int class_index;
+        if (!parseIrisLine(line, values, class_index)) {
+            continue;
+        }
+        features.insert(features.end(), values, values + 4);
+        labels.push_back(class_index);
+    }
+
+    // Scatter the row-per-sample records into column-per-sample matrices
+    const int n = static_cast<int>(labels.size());
+    Dataset data;
+    data.inputs = Matrix<float>(4, n);
+    data.targets = Matrix<float>(3, n);
+    for (int s = 0; s < n; ++s) {
+        for (int i = 0; i < 4; ++i)
+            data.inputs.set(i, s, features[s * 4 + i]);
+        data.targets.set(labels[s], s, 1.0f);
+    }
+
+    return data;
+}
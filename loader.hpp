@@ -4,9 +4,32 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include <cstddef>
 
 std::pair<std::vector<Matrix<float>>, std::vector<Matrix<float>>>
 loadIrisDataset(const std::string& path);
 
 std::pair<std::vector<Matrix<float>>, std::vector<Matrix<float>>>
 generateXORDataset();
+
+/* A whole dataset held in two contiguous matrices, one column per sample.
+   Samples and batches are handed out as views into that storage, so neither
+   training nor evaluation has to copy them. */
+struct Dataset {
+    Matrix<float> inputs{0, 0};   // features x samples
+    Matrix<float> targets{0, 0};  // one-hot classes x samples
+
+    std::size_t size() const { return static_cast<std::size_t>(inputs.cols()); }
+
+    MatrixView<const float> input(std::size_t i) const { return inputs.view().col(static_cast<int>(i)); }
+    MatrixView<const float> target(std::size_t i) const { return targets.view().col(static_cast<int>(i)); }
+
+    MatrixView<const float> inputBatch(std::size_t first, std::size_t count) const {
+        return inputs.view().block(0, static_cast<int>(first), inputs.rows(), static_cast<int>(count));
+    }
+    MatrixView<const float> targetBatch(std::size_t first, std::size_t count) const {
+        return targets.view().block(0, static_cast<int>(first), targets.rows(), static_cast<int>(count));
+    }
+};
+
+Dataset loadIrisBatch(const std::string& path);
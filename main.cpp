@@ -9,8 +9,129 @@
 #include "matrix.hpp"
 #include "neuralnetwork.hpp"
 #include "loader.hpp"
+#include "evaluation.hpp"
+#include "inference_server.hpp"
+#include "sweep.hpp"
 
-int main(void) {
+#include <csignal>
+#include <cstdlib>
+
+namespace {
+
+InferenceServer* active_server = nullptr;
+
+void stopServer(int /*signal*/) {
+  if (active_server) {
+    active_server->stop();
+  }
+}
+
+/* neuralnet serve <model.bin> <socket> [max_clients] [max_batch] */
+int serve(int argc, char** argv) {
+  if (argc < 4) {
+    std::cerr << "Usage: " << argv[0] << " serve <model.bin> <socket> [max_clients] [max_batch]\n";
+    return 2;
+  }
+
+  InferenceServerOptions options;
+  if (argc > 4) options.max_clients = std::atoi(argv[4]);
+  if (argc > 5) options.max_batch = std::atoi(argv[5]);
+
+  try {
+    InferenceServer server(argv[2], argv[3], options);
+    active_server = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    server.run();
+    active_server = nullptr;
+  } catch (const std::exception& e) {
+    active_server = nullptr;
+    std::cerr << "Server failed: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+/* neuralnet tune <model.bin> [batch] [max_threads]
+   Tunes the GEMM shapes of the model at that batch size and stores the
+   winners in the per-machine cache read by build() and load(). */
+int tune(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " tune <model.bin> [batch] [max_threads]\n";
+    return 2;
+  }
+
+  NeuralNet<float> net;
+  net.load(argv[2]);
+  int batch = argc > 3 ? std::atoi(argv[3]) : 1;
+  gemm::TuneOptions options;
+  if (argc > 4) options.max_threads = std::atoi(argv[4]);
+
+  std::cout << "CPU: " << gemm::cpuModel() << "\ncache: " << gemm::defaultCachePath() << "\n";
+  for (const gemm::TuneResult& result : net.autotune(batch, options)) {
+    const gemm::Shape& s = result.shape;
+    const gemm::Config& c = result.config;
+    std::cout << "  " << s.m << "x" << s.n << "x" << s.k << ": ";
+    if (c.isReference()) {
+      std::cout << "reference kernel";
+    } else {
+      std::cout << "mc " << c.mc << " nc " << c.nc << " kc " << c.kc << " mr " << c.mr
+                << " threads " << c.threads;
+    }
+    if (result.cached) {
+      std::cout << " (cached)\n";
+    } else {
+      std::cout << ", " << result.gflops() << " GFLOP/s, "
+                << result.reference_seconds / result.seconds << "x vs reference\n";
+    }
+  }
+  return 0;
+}
+
+/* neuralnet sweep <data> <out_dir> [threads] [threads_per_trial] [max_epochs]
+   Sweeps layer sizes, activation, initializer and learning rate over an
+   Iris-format dataset with successive halving, then writes the best model
+   to <out_dir>/best.bin and the results table to <out_dir>/results.tsv. */
+int runSweep(int argc, char** argv) {
+  if (argc < 4) {
+    std::cerr << "Usage: " << argv[0] << " sweep <data> <out_dir> [threads] [threads_per_trial] [max_epochs]\n";
+    return 2;
+  }
+
+  sweep::Options options;
+  if (argc > 4) options.threads = std::atoi(argv[4]);
+  if (argc > 5) options.threads_per_trial = std::atoi(argv[5]);
+  if (argc > 6) options.max_epochs = std::atoi(argv[6]);
+
+  sweep::Space space;
+  space.hidden = {{4}, {6}, {8}, {16}, {8, 8}};
+  space.activations = {"Sigmoid", "Tanh", "ReLU"};
+  space.initializers = {"Xavier", "He"};
+  space.learning_rates = {0.01f, 0.05f, 0.1f, 0.5f};
+  std::vector<sweep::Trial> trials = space.grid();
+
+  sweep::SharedDataset data(loadIrisBatch(argv[2]), options.validation_fraction, options.seed);
+  sweep::Report report = sweep::run(data, trials, options);
+
+  const std::string out_dir = argv[3];
+  std::ofstream table(out_dir + "/results.tsv");
+  if (!table) {
+    std::cerr << "Cannot write " << out_dir << "/results.tsv\n";
+    return 1;
+  }
+  report.writeTable(table);
+  report.best_model.save(out_dir + "/best.bin");
+
+  const sweep::Result& best = report.results[report.best];
+  std::cout << trials.size() << " trials, " << report.rungs << " rungs, " << report.epochs
+            << " epochs trained in " << report.seconds << " s\n"
+            << "best: " << best.trial.describe() << ", validation loss " << best.validation_loss
+            << ", accuracy " << best.validation_accuracy * 100.0 << "%\n"
+            << "wrote " << out_dir << "/best.bin and " << out_dir << "/results.tsv\n";
+  return 0;
+}
+
+int irisExample() {
 
   NeuralNet<float> net;
   net.setLayerSizes({4, 6, 3});
@@ -18,15 +139,34 @@ int main(void) {
   net.pickInitializer("Xavier");
   net.build();
 
-  auto [inputs, targets] = loadIrisDataset("datasets/iris.data");
+  Dataset data = loadIrisBatch("datasets/iris.data");
 
   auto start = std::chrono::high_resolution_clock::now();
 
+  /* Validation runs on a snapshot of the weights in the background while
+     training carries on; a new round starts once the previous one is done. */
+  std::future<evaluation::Report> pending;
+  auto report_validation = [&pending]() {
+    evaluation::Report report = pending.get();
+    std::cout << "Validation accuracy: " << report.accuracy() * 100.0
+              << "%, loss: " << report.loss() << "\n";
+  };
+
   for (int epoch = 0; epoch < 10000; ++epoch) {
-    for (std::size_t i = 0; i < inputs.size(); ++i) {
-      net.train(inputs[i], targets[i], 0.1f);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+      net.train(data.input(i), data.target(i), 0.1f);
+    }
+
+    if ((epoch + 1) % 1000 == 0) {
+      if (pending.valid()) {
+        report_validation();
+      }
+      pending = evaluation::evaluateAsync(net, data.inputs, data.targets);
     }
   }
+  if (pending.valid()) {
+    report_validation();
+  }
 
   auto end = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = end - start;
@@ -36,19 +176,25 @@ int main(void) {
 
   NeuralNet<float> net2;
   net2.load("models/test.bin");
-  int correct = 0;
-  for (std::size_t i = 0; i < inputs.size(); ++i) {
-      Matrix<float> prediction = net2.predict(inputs[i]);
-      int predicted_class = prediction.argmax();
-      int true_class = targets[i].argmax();
-
-      if (predicted_class == true_class) {
-          ++correct;
-      }
-  }
-
-  float accuracy = static_cast<float>(correct) / inputs.size();
-  std::cout << "Accuracy: " << accuracy * 100.0f << "%\n";
+  evaluation::Options options;
+  options.top_k = 2;
+  evaluation::Report report = evaluation::evaluate(net2, data.inputs, data.targets, options);
+  report.print();
 
 	return 1;
 }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 1 && std::string(argv[1]) == "serve") {
+    return serve(argc, argv);
+  }
+  if (argc > 1 && std::string(argv[1]) == "tune") {
+    return tune(argc, argv);
+  }
+  if (argc > 1 && std::string(argv[1]) == "sweep") {
+    return runSweep(argc, argv);
+  }
+  return irisExample();
+}
@@ -3,16 +3,75 @@
 
 #include <vector>
 #include <iostream>
-#include <random>
+#include <algorithm>
 #include <type_traits>
 #include <cassert>
 #include <functional>
 
+#include "aligned_allocator.hpp"
+#include "gemm.hpp"
+#include "random.hpp"
+
+template<typename T>
+class Matrix;
+
+/* Non-owning, strided window onto matrix data.
+
+   A view is a pointer plus shape and per-axis strides (in elements), so it can
+   describe a whole Matrix, a block of rows/columns, a single sample column of
+   a batch, a transpose, or memory owned by someone else (an mmap'ed model
+   file, a shared-memory slot, a packed GEMM panel). Views are cheap to copy
+   and never allocate. Use MatrixView<const T> for read-only access. */
+template<typename T>
+class MatrixView {
+public:
+  using value_type = std::remove_const_t<T>;
+  using owner_type = std::conditional_t<std::is_const<T>::value,
+                                        const Matrix<value_type>,
+                                        Matrix<value_type>>;
+
+  MatrixView(T* data, int rows, int cols);
+  MatrixView(T* data, int rows, int cols, int row_stride, int col_stride);
+  MatrixView(owner_type& matrix);
+
+  /* Allow MatrixView<T> to be passed where MatrixView<const T> is expected. */
+  template<typename U, typename = std::enable_if_t<std::is_same<const U, T>::value &&
+                                                   !std::is_same<U, T>::value>>
+  MatrixView(const MatrixView<U>& other);
+
+  T& operator()(int row, int col) const;
+
+  T* data() const { return data_; }
+  int rows() const { return rows_; }
+  int cols() const { return cols_; }
+  int rowStride() const { return row_stride_; }
+  int colStride() const { return col_stride_; }
+  bool isContiguous() const;
+
+  /* Sub-views. None of these copy data. */
+  MatrixView<T> block(int row, int col, int rows, int cols) const;
+  MatrixView<T> row(int index) const;
+  MatrixView<T> col(int index) const;
+  MatrixView<T> transpose() const;
+
+private:
+  T* data_;
+  int rows_;
+  int cols_;
+  int row_stride_;
+  int col_stride_;
+};
+
 /* Class Definition */
 template<typename T>
 class Matrix {
 public:
+	/* Read-only view type. Also handy as a non-deduced parameter type so
+	   callers may pass a Matrix, a MatrixView<T> or a MatrixView<const T>. */
+	using ConstView = MatrixView<const T>;
+
 	Matrix(int rows, int cols);
+	explicit Matrix(MatrixView<const T> view);
 	~Matrix();
 	void print() const;
 
@@ -29,39 +88,168 @@ public:
 	void fillRandom(T min, T max);
 	void fillNormal(T mean, T stddev);
 
-	/* Math functions */
-	void add(const Matrix<T>& b);
-	void subtract(const Matrix<T>& b);
-	void hadamard(const Matrix<T>& b);
+	/* Reproducible fills: the result depends only on the stream, never on the
+	   number of threads used (threads <= 0 means all cores). */
+	void fillRandom(T min, T max, const rng::Stream& stream, int threads = 0);
+	void fillNormal(T mean, T stddev, const rng::Stream& stream, int threads = 0);
+
+	/* Math functions. Operands may be a Matrix or any MatrixView. */
+	void add(MatrixView<const T> b);
+	void subtract(MatrixView<const T> b);
+	void hadamard(MatrixView<const T> b);
 	void multiply(T scalar);
+  void addColumnVector(MatrixView<const T> column);
   Matrix<T> transpose() const;
-  Matrix<T> matMul(const Matrix<T>& other) const;
+  Matrix<T> matMul(MatrixView<const T> other) const;
 
   T sum() const;
   T mean() const;
+  Matrix<T> rowSums() const;
 
   void apply(std::function<T(T)> func);
 
-  int rows();
-  int cols();
+  int rows() const;
+  int cols() const;
 
   int argmax() const;
 
+  /* Raw access to the 64-byte aligned, row-major storage. */
+  T* data() { return data_.data(); }
+  const T* data() const { return data_.data(); }
+
+  MatrixView<T> view() { return MatrixView<T>(*this); }
+  MatrixView<const T> view() const { return MatrixView<const T>(*this); }
+
 private:
 	int rows_;
 	int cols_;
-	std::vector<T> data_;
+	std::vector<T, AlignedAllocator<T>> data_;
 };
 
+/* Free functions working purely on views. matMulInto writes a * b into a
+   preallocated output view, which must not alias either operand. */
+template<typename T>
+void matMulInto(MatrixView<const T> a, MatrixView<const T> b, MatrixView<T> out);
+
+template<typename T>
+Matrix<T> matMul(MatrixView<const T> a, MatrixView<const T> b);
+
+namespace detail {
+
+/* y[j] += alpha * x[j] and z[j] += x[j] * y[j] over n unit-stride elements.
+   Written as blocks of eight independent updates so that GCC's -O2
+   vectorizer (which will not version a plain loop for aliasing or add a
+   remainder loop) turns each block into SIMD code. */
+template<typename T>
+inline void axpy(int n, T alpha, const T* x, T* y) {
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    T block[8];
+    for (int u = 0; u < 8; ++u) block[u] = y[j + u] + alpha * x[j + u];
+    for (int u = 0; u < 8; ++u) y[j + u] = block[u];
+  }
+  for (; j < n; ++j) {
+    y[j] += alpha * x[j];
+  }
+}
+
+template<typename T>
+inline void multiplyAdd(int n, const T* x, const T* y, T* z) {
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    T block[8];
+    for (int u = 0; u < 8; ++u) block[u] = z[j + u] + x[j + u] * y[j + u];
+    for (int u = 0; u < 8; ++u) z[j + u] = block[u];
+  }
+  for (; j < n; ++j) {
+    z[j] += x[j] * y[j];
+  }
+}
+
+/* The untuned i-k-j kernel; also the baseline the GEMM tuner measures. */
+template<typename T>
+void matMulReference(MatrixView<const T> a, MatrixView<const T> b, MatrixView<T> out);
+
+}  // namespace detail
+
+/* MatrixView Implementations */
+template<typename T>
+MatrixView<T>::MatrixView(T* data, int rows, int cols)
+  : MatrixView(data, rows, cols, cols, 1) {
+}
+
+template<typename T>
+MatrixView<T>::MatrixView(T* data, int rows, int cols, int row_stride, int col_stride)
+  : data_(data), rows_(rows), cols_(cols), row_stride_(row_stride), col_stride_(col_stride) {
+  assert(rows >= 0 && cols >= 0);
+}
+
+template<typename T>
+MatrixView<T>::MatrixView(owner_type& matrix)
+  : MatrixView(matrix.data(), matrix.rows(), matrix.cols()) {
+}
+
+template<typename T>
+template<typename U, typename>
+MatrixView<T>::MatrixView(const MatrixView<U>& other)
+  : MatrixView(other.data(), other.rows(), other.cols(), other.rowStride(), other.colStride()) {
+}
+
+template<typename T>
+T& MatrixView<T>::operator()(int row, int col) const {
+  assert(row >= 0 && row < rows_);
+  assert(col >= 0 && col < cols_);
+  return data_[static_cast<std::ptrdiff_t>(row) * row_stride_ +
+               static_cast<std::ptrdiff_t>(col) * col_stride_];
+}
+
+template<typename T>
+bool MatrixView<T>::isContiguous() const {
+  return (col_stride_ == 1 || cols_ <= 1) && (row_stride_ == cols_ || rows_ <= 1);
+}
+
+template<typename T>
+MatrixView<T> MatrixView<T>::block(int row, int col, int rows, int cols) const {
+  assert(row >= 0 && col >= 0 && row + rows <= rows_ && col + cols <= cols_);
+  T* start = data_ + static_cast<std::ptrdiff_t>(row) * row_stride_ +
+             static_cast<std::ptrdiff_t>(col) * col_stride_;
+  return MatrixView<T>(start, rows, cols, row_stride_, col_stride_);
+}
+
+template<typename T>
+MatrixView<T> MatrixView<T>::row(int index) const {
+  return block(index, 0, 1, cols_);
+}
+
+template<typename T>
+MatrixView<T> MatrixView<T>::col(int index) const {
+  return block(0, index, rows_, 1);
+}
+
+template<typename T>
+MatrixView<T> MatrixView<T>::transpose() const {
+  return MatrixView<T>(data_, cols_, rows_, col_stride_, row_stride_);
+}
+
 /* Function Implementations */
 template<typename T>
 Matrix<T>::Matrix(int rows, int cols) {
 	rows_ = rows;
 	cols_ = cols;
-	data_ = std::vector<T>(rows * cols, T{});
+	data_ = std::vector<T, AlignedAllocator<T>>(rows * cols, T{});
 	//std::cout << "Creating matrix of " << rows_ << "x" << cols_ << " size\n";
 };
 
+template<typename T>
+Matrix<T>::Matrix(MatrixView<const T> view) : Matrix(view.rows(), view.cols()) {
+  T* out = data_.data();
+  for (int i = 0; i < rows_; ++i) {
+    for (int j = 0; j < cols_; ++j) {
+      out[i * cols_ + j] = view(i, j);
+    }
+  }
+}
+
 template<typename T>
 Matrix<T>::~Matrix() {
 }
@@ -80,7 +268,7 @@ void Matrix<T>::print() const {
 template<typename T>
 T Matrix<T>::get(int row, int col) const {
   assert(row >= 0 && row < rows_);
-  assert(col >= 0 && row < rows_);
+  assert(col >= 0 && col < cols_);
   return data_[row * cols_ + col];
 }
 
@@ -93,7 +281,7 @@ T Matrix<T>::get(int index) const {
 template<typename T>
 void Matrix<T>::set(int row, int col, T value) {
   assert(row >= 0 && row < rows_);
-  assert(col >= 0 && row < rows_);
+  assert(col >= 0 && col < cols_);
   data_[row * cols_ + col] = value;
 }
 
@@ -105,62 +293,81 @@ void Matrix<T>::set(int index, T value) {
 
 template<typename T>
 void Matrix<T>::fill(T value) {
-  for (std::size_t i = 0; i < data_.size(); ++i) {
-    set(i, value);
-  }
+  std::fill(data_.begin(), data_.end(), value);
 }
 
 template<typename T>
 void Matrix<T>::fillRandom(T min, T max) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-
-	if constexpr (std::is_integral<T>::value) {
-	  std::uniform_int_distribution<T> dist(min, max);
-	  for (std::size_t i = 0; i < data_.size(); ++i) {
-			set(i, dist(gen));
-		}
-	} else if constexpr (std::is_floating_point<T>::value) {
-	  std::uniform_real_distribution<T> dist(min, max);
-	  for (std::size_t i = 0; i < data_.size(); ++i) {
-			set(i, dist(gen));
-		}
-	} else {
-		static_assert(false, "Unsupported type for fillRandom()");
-	}
+  fillRandom(min, max, rng::Stream{rng::entropySeed(), 0});
 }
 
 template<typename T>
 void Matrix<T>::fillNormal(T mean, T stddev) {
-  static_assert(std::is_floating_point<T>::value, "fillNormal() requires a floating-point type");
+  fillNormal(mean, stddev, rng::Stream{rng::entropySeed(), 0});
+}
+
+template<typename T>
+void Matrix<T>::fillRandom(T min, T max, const rng::Stream& stream, int threads) {
+  static_assert(std::is_arithmetic<T>::value, "Unsupported type for fillRandom()");
+  rng::fillUniform(data_.data(), data_.size(), stream, min, max, threads);
+}
 
-  std::random_device rd;
-	std::mt19937 gen(rd());
-	std::normal_distribution<T> dist(mean, stddev);
+template<typename T>
+void Matrix<T>::fillNormal(T mean, T stddev, const rng::Stream& stream, int threads) {
+  static_assert(std::is_floating_point<T>::value, "fillNormal() requires a floating-point type");
+  rng::fillNormal(data_.data(), data_.size(), stream, mean, stddev, threads);
+}
 
-  for (std::size_t i = 0; i < data_.size(); ++i) {
-    set(i, dist(gen));
+namespace detail {
+
+/* Applies out[i][j] = op(out[i][j], b(i, j)) with a flat loop when b is laid
+   out exactly like this matrix, and a strided walk otherwise. */
+template<typename T, typename Op>
+inline void elementwise(T* out, int rows, int cols, MatrixView<const T> b, Op op) {
+  assert(b.rows() == rows && b.cols() == cols);
+  if (b.isContiguous()) {
+    const T* in = b.data();
+    const std::size_t n = static_cast<std::size_t>(rows) * cols;
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = op(out[i], in[i]);
+    }
+    return;
+  }
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      out[i * cols + j] = op(out[i * cols + j], b(i, j));
+    }
   }
 }
 
+}  // namespace detail
+
 template<typename T>
-void Matrix<T>::add(const Matrix<T>& b) {
-  for (std::size_t i = 0; i < data_.size(); ++i) {
-    set(i, get(i) + b.get(i));
-  }
+void Matrix<T>::add(MatrixView<const T> b) {
+  detail::elementwise(data_.data(), rows_, cols_, b, [](T x, T y) { return x + y; });
 }
 
 template<typename T>
-void Matrix<T>::subtract(const Matrix<T>& b) {
-  for (std::size_t i = 0; i < data_.size(); ++i) {
-    set(i, get(i) - b.get(i));
-  }
+void Matrix<T>::subtract(MatrixView<const T> b) {
+  detail::elementwise(data_.data(), rows_, cols_, b, [](T x, T y) { return x - y; });
 }
 
 template<typename T>
-void Matrix<T>::hadamard(const Matrix<T>& b) {
-  for (std::size_t i = 0; i < data_.size(); ++i) {
-    set(i, get(i) * b.get(i));
+void Matrix<T>::hadamard(MatrixView<const T> b) {
+  detail::elementwise(data_.data(), rows_, cols_, b, [](T x, T y) { return x * y; });
+}
+
+/* Broadcast add of a rows x 1 vector to every column, e.g. a bias vector
+   onto a batch of pre-activations stored one sample per column. */
+template<typename T>
+void Matrix<T>::addColumnVector(MatrixView<const T> column) {
+  assert(column.rows() == rows_ && column.cols() == 1);
+  for (int i = 0; i < rows_; ++i) {
+    const T value = column(i, 0);
+    T* row = data_.data() + static_cast<std::ptrdiff_t>(i) * cols_;
+    for (int j = 0; j < cols_; ++j) {
+      row[j] += value;
+    }
   }
 }
 
@@ -192,25 +399,128 @@ T Matrix<T>::sum() const {
   return result;
 }
 
+/* rows x 1 vector of per-row sums, e.g. a bias gradient summed over a batch. */
+template<typename T>
+Matrix<T> Matrix<T>::rowSums() const {
+  Matrix<T> output(rows_, 1);
+  for (int i = 0; i < rows_; ++i) {
+    T result = T{};
+    for (int j = 0; j < cols_; ++j) {
+      result += data_[i * cols_ + j];
+    }
+    output.data_[i] = result;
+  }
+  return output;
+}
+
 template<typename T>
 T Matrix<T>::mean() const {
   return sum() / static_cast<T>(rows_ * cols_);
 }
 
 template<typename T>
-Matrix<T> Matrix<T>::matMul(const Matrix<T>& other) const {
-  assert(this->cols_ == other.rows_);
+Matrix<T> Matrix<T>::matMul(MatrixView<const T> other) const {
+  return ::matMul<T>(view(), other);
+}
 
-  Matrix<T> output(this->rows_, other.cols_);
-  for (int i = 0; i < this->rows_; ++i) {
-    for (int j = 0; j < other.cols_; ++j) {
+/* Shapes tuned for this machine (gemm::table()) run the blocked kernel from
+   gemm.hpp; everything else runs matMulReference. Both give bit-identical
+   results. The table lookup reads an immutable snapshot and takes no lock. */
+template<typename T>
+void matMulInto(MatrixView<const T> a, MatrixView<const T> b, MatrixView<T> out) {
+  assert(a.cols() == b.rows());
+  assert(out.rows() == a.rows() && out.cols() == b.cols());
+
+  if (out.colStride() == 1) {
+    std::optional<gemm::Config> config =
+        gemm::table().find(gemm::Shape{a.rows(), b.cols(), a.cols(), static_cast<int>(sizeof(T))});
+    if (config && !config->isReference()) {
+      gemm::multiply<T>(*config, a.rows(), b.cols(), a.cols(),
+                        a.data(), a.rowStride(), a.colStride(),
+                        b.data(), b.rowStride(), b.colStride(),
+                        out.data(), out.rowStride());
+      return;
+    }
+  }
+  detail::matMulReference<T>(a, b, out);
+}
+
+namespace detail {
+
+template<typename T>
+void matMulReference(MatrixView<const T> a, MatrixView<const T> b, MatrixView<T> out) {
+  const int n = b.cols();
+  const bool unit_stride = b.colStride() == 1 && out.colStride() == 1;
+
+  /* Matrix-vector products (a single sample) as plain dot products; the
+     i-k-j loop below would run its inner loop over one column only. Four
+     rows are summed side by side so their dependency chains overlap; each
+     sum still runs over k in ascending order. */
+  if (n == 1) {
+    const std::ptrdiff_t a_rs = a.rowStride();
+    const std::ptrdiff_t a_cs = a.colStride();
+    const std::ptrdiff_t b_rs = b.rowStride();
+    const std::ptrdiff_t out_rs = out.rowStride();
+    const T* x = b.data();
+    int i = 0;
+    for (; i + 4 <= a.rows(); i += 4) {
+      const T* a0 = a.data() + static_cast<std::ptrdiff_t>(i) * a_rs;
+      T s0 = T{}, s1 = T{}, s2 = T{}, s3 = T{};
+      for (int k = 0; k < a.cols(); ++k) {
+        const T x_k = x[k * b_rs];
+        const T* a_k = a0 + k * a_cs;
+        s0 += a_k[0] * x_k;
+        s1 += a_k[a_rs] * x_k;
+        s2 += a_k[2 * a_rs] * x_k;
+        s3 += a_k[3 * a_rs] * x_k;
+      }
+      T* dst = out.data() + static_cast<std::ptrdiff_t>(i) * out_rs;
+      dst[0] = s0;
+      dst[out_rs] = s1;
+      dst[2 * out_rs] = s2;
+      dst[3 * out_rs] = s3;
+    }
+    for (; i < a.rows(); ++i) {
+      const T* a_row = a.data() + static_cast<std::ptrdiff_t>(i) * a_rs;
       T sum = T{};
-      for (int k = 0; k < this->cols_; ++k) {
-        sum += this->get(i * this->cols_ + k) * other.get(k * other.cols_ + j);
+      for (int k = 0; k < a.cols(); ++k) {
+        sum += a_row[k * a_cs] * x[k * b_rs];
       }
-      output.set(i * output.cols_ + j, sum);
+      out.data()[static_cast<std::ptrdiff_t>(i) * out_rs] = sum;
     }
+    return;
   }
+
+  /* i-k-j order: each output row is accumulated as a sum of scaled rows of b,
+     so the inner loop streams through b and out with unit stride whenever the
+     views allow it. Every out(i, j) still sums over k in ascending order. */
+  for (int i = 0; i < a.rows(); ++i) {
+    T* out_row = out.data() + static_cast<std::ptrdiff_t>(i) * out.rowStride();
+    for (int j = 0; j < n; ++j) {
+      out_row[static_cast<std::ptrdiff_t>(j) * out.colStride()] = T{};
+    }
+    for (int k = 0; k < a.cols(); ++k) {
+      const T a_ik = a.data()[static_cast<std::ptrdiff_t>(i) * a.rowStride() +
+                              static_cast<std::ptrdiff_t>(k) * a.colStride()];
+      const T* b_row = b.data() + static_cast<std::ptrdiff_t>(k) * b.rowStride();
+      if (unit_stride) {
+        axpy(n, a_ik, b_row, out_row);
+      } else {
+        for (int j = 0; j < n; ++j) {
+          out_row[static_cast<std::ptrdiff_t>(j) * out.colStride()] +=
+              a_ik * b_row[static_cast<std::ptrdiff_t>(j) * b.colStride()];
+        }
+      }
+    }
+  }
+}
+
+}  // namespace detail
+
+template<typename T>
+Matrix<T> matMul(MatrixView<const T> a, MatrixView<const T> b) {
+  Matrix<T> output(a.rows(), b.cols());
+  matMulInto<T>(a, b, output.view());
   return output;
 }
 
@@ -222,12 +532,12 @@ void Matrix<T>::apply(std::function<T(T)> func) {
 }
 
 template<typename T>
-int Matrix<T>::rows() {
+int Matrix<T>::rows() const {
   return rows_;
 }
 
 template<typename T>
-int Matrix<T>::cols() {
+int Matrix<T>::cols() const {
   return cols_;
 }
 
@@ -3,15 +3,21 @@
 
 #include <vector>
 #include <iostream>
+#include <algorithm>
 #include <cassert>
 #include <functional>
 #include <string>
 #include <fstream>
 #include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <atomic>
 
 #include "matrix.hpp"
+#include "gemm_tuner.hpp"
 #include "activation.hpp"
 #include "initializer.hpp"
+#include "parallel.hpp"
 
 /* Class Definition */
 template<typename T>
@@ -20,14 +26,74 @@ public:
 	NeuralNet();
 	~NeuralNet();
 
-	Matrix<T> predict(const Matrix<T>& input);
-	void train(const Matrix<T>& input, const Matrix<T>& target, T learning_rate);
+	/* Inputs hold one sample per column, so a features x B matrix (or view)
+	   is predicted as a batch. The threaded overload splits the batch columns
+	   across threads; threads <= 0 uses every core. */
+	Matrix<T> predict(MatrixView<const T> input) const;
+	Matrix<T> predict(MatrixView<const T> input, int threads) const;
+	/* Trains on one sample or a features x B batch (gradients are averaged
+	   over the batch columns). */
+	void train(MatrixView<const T> input, MatrixView<const T> target, T learning_rate);
+
+	/* Gradient checkpointing. With an interval k > 1, train() keeps only every
+	   k-th layer's activations and recomputes the rest during the backward
+	   pass: activation memory drops from O(L) to O(L/k + k) matrices for at
+	   most one extra forward pass. k <= 1 stores everything (the default). */
+	void setCheckpointInterval(int interval);
+	int checkpointInterval() const;
+
+	/* Data-parallel training support. Parameters and gradients are flat
+	   vectors laid out like the save file: weights[0..L) then biases[0..L),
+	   each row-major. gradients() returns the batch-averaged gradient of
+	   the squared error at the current weights without changing them (so
+	   several threads may call it at once), and applyGradients() takes one
+	   SGD step with it. */
+	std::size_t parameterCount() const;
+	std::vector<T> parameters() const;
+	void setParameters(const std::vector<T>& parameters);
+	std::vector<T> gradients(MatrixView<const T> input, MatrixView<const T> target) const;
+	void applyGradients(const std::vector<T>& gradients, T learning_rate);
+
+	struct TrainStats {
+	  std::size_t peak_activation_bytes = 0;  // activations alive at once in the last train()
+	};
+	const TrainStats& lastTrainStats() const;
+
+	/* Changes whenever predict() results may change: build(), load(),
+	   train(), setParameters(), applyGradients() and setActivation() each
+	   take a new value from a process-wide counter, so two networks only
+	   share a version when one is a copy of the other. Result caches
+	   (prediction_cache.hpp) compare it to drop stale entries. */
+	uint64_t weightsVersion() const;
 
 	/* Configuration functions. */
 	void setActivation(const std::string& type);
 	void pickInitializer(const std::string& type);
 	void setLayerSizes(const std::vector<int>& layers);
 
+	/* Weight initialization. With a seed set, build() produces bit-identical
+	   weights regardless of the thread count; threads <= 0 uses every core. */
+	void setSeed(uint64_t seed);
+	void setThreads(int threads);
+	uint64_t seed() const;
+
+	/* build() and load() report what they did on std::cout unless turned
+	   off, e.g. for code that builds many networks at once. */
+	void setVerbose(bool verbose);
+
+	const std::vector<int>& layerSizes() const;
+	const std::vector<Matrix<T>>& weights() const;
+	const std::vector<Matrix<T>>& biases() const;
+	const std::string& activationName() const;
+
+	/* GEMM autotuning. gemmShapes() lists the (M, N, K) of every matMul that
+	   predict() and train() run at this batch size; autotune() benchmarks the
+	   shapes not yet in gemm::table(), records the winners and writes them to
+	   the per-machine cache (gemm::defaultCachePath()). build() and load()
+	   read that cache, so later runs skip tuning. */
+	std::vector<gemm::Shape> gemmShapes(int batch) const;
+	std::vector<gemm::TuneResult> autotune(int batch, const gemm::TuneOptions& options = gemm::TuneOptions());
+
 	/* Build function. */
 	void build();
 
@@ -40,17 +106,61 @@ private:
   std::vector<Matrix<T>> biases_;
   std::function<T(T)> activation_;
   std::function<T(T)> activation_derivative_;
-  std::function<void(Matrix<T>&, int, int)> initializer_;
+  std::function<void(Matrix<T>&, int, int, const initializer::Context&)> initializer_;
   bool built_ = false;
   bool initializer_was_set_ = false;
+  bool seed_was_set_ = false;
+  uint64_t seed_ = 0;
+  int threads_ = 0;
+  bool verbose_ = true;
+  int checkpoint_interval_ = 1;
+  TrainStats last_train_stats_;
+  uint64_t weights_version_ = 0;
 
   std::string activation_name_;
   std::string initializer_name_;
 
-  std::vector<Matrix<T>> forward(const Matrix<T>& input);
-  void backward(const std::vector<Matrix<T>>& activations, const Matrix<T>& target, T learning_rate);
+  Matrix<T> layerForward(std::size_t layer, MatrixView<const T> input) const;
+  std::vector<Matrix<T>> forward(MatrixView<const T> input) const;
+  Matrix<T> outputDelta(const Matrix<T>& output, MatrixView<const T> target) const;
+  void backwardRange(std::size_t first, std::size_t last, const std::vector<Matrix<T>>& activations,
+                     Matrix<T>& delta, T learning_rate);
+  void backward(const std::vector<Matrix<T>>& activations, MatrixView<const T> target, T learning_rate);
+  void trainCheckpointed(MatrixView<const T> input, MatrixView<const T> target, T learning_rate);
 };
 
+/* Runs a stack of dense layers whose parameters live outside a NeuralNet
+   (shared memory, per-NUMA-node replicas, ...). Same arithmetic as
+   NeuralNet::predict(); input is features x batch. */
+template<typename T>
+Matrix<T> forwardLayers(const std::vector<MatrixView<const T>>& weights,
+                        const std::vector<MatrixView<const T>>& biases,
+                        const std::function<T(T)>& activation,
+                        MatrixView<const T> input) {
+  assert(!weights.empty() && weights.size() == biases.size());
+
+  Matrix<T> output = matMul<T>(weights[0], input);
+  output.addColumnVector(biases[0]);
+  output.apply(activation);
+
+  for (std::size_t i = 1; i < weights.size(); ++i) {
+    Matrix<T> z = matMul<T>(weights[i], output);
+    z.addColumnVector(biases[i]);
+    z.apply(activation);
+    output = std::move(z);
+  }
+  return output;
+}
+
+namespace detail {
+
+inline uint64_t nextWeightsVersion() {
+  static std::atomic<uint64_t> counter{0};
+  return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+}  // namespace detail
+
 /* Functions */
 template<typename T>
 NeuralNet<T>::NeuralNet() {
@@ -61,89 +171,321 @@ NeuralNet<T>::~NeuralNet() {
 }
 
 template<typename T>
-Matrix<T> NeuralNet<T>::predict(const Matrix<T>& input) {
-  Matrix<T> activation = input;
+Matrix<T> NeuralNet<T>::predict(MatrixView<const T> input) const {
+  Matrix<T> activation = matMul<T>(weights_[0], input);
+  activation.addColumnVector(biases_[0]);
+  activation.apply(activation_);
 
-  for (std::size_t i = 0; i < layer_sizes_.size() - 1; ++i) {
+  for (std::size_t i = 1; i < layer_sizes_.size() - 1; ++i) {
     Matrix<T> z = weights_[i].matMul(activation);
-    z.add(biases_[i]);
+    z.addColumnVector(biases_[i]);
     z.apply(activation_);
-    activation = z;
+    activation = std::move(z);
   }
 
   return activation;
 }
 
 template<typename T>
-std::vector<Matrix<T>> NeuralNet<T>::forward(const Matrix<T>& input) {
+Matrix<T> NeuralNet<T>::predict(MatrixView<const T> input, int threads) const {
+  /* Below this many samples per thread, spawning costs more than it saves. */
+  constexpr std::size_t kMinColumnsPerThread = 32;
+
+  Matrix<T> output(layer_sizes_.back(), input.cols());
+  MatrixView<T> out = output.view();
+
+  parallel::forRange(static_cast<std::size_t>(input.cols()), threads,
+                     [&](std::size_t begin, std::size_t end) {
+    int first = static_cast<int>(begin);
+    int count = static_cast<int>(end - begin);
+    Matrix<T> chunk = predict(input.block(0, first, input.rows(), count));
+    MatrixView<T> target = out.block(0, first, out.rows(), count);
+    for (int r = 0; r < chunk.rows(); ++r) {
+      for (int c = 0; c < count; ++c) {
+        target(r, c) = chunk.get(r, c);
+      }
+    }
+  }, kMinColumnsPerThread);
+
+  return output;
+}
+
+template<typename T>
+Matrix<T> NeuralNet<T>::layerForward(std::size_t layer, MatrixView<const T> input) const {
+  Matrix<T> z = matMul<T>(weights_[layer], input);
+  z.addColumnVector(biases_[layer]);
+  z.apply(activation_);
+  return z;
+}
+
+template<typename T>
+std::vector<Matrix<T>> NeuralNet<T>::forward(MatrixView<const T> input) const {
   std::vector<Matrix<T>> activations;
-  Matrix<T> activation = input;
-  activations.push_back(activation);
+  activations.emplace_back(input);
 
   for (std::size_t i = 0; i < layer_sizes_.size() - 1; ++i) {
-    Matrix<T> z = weights_[i].matMul(activation);
-    z.add(biases_[i]);
-    z.apply(activation_);
-    activation = z;
-    activations.push_back(activation);
+    activations.push_back(layerForward(i, activations.back()));
   }
 
   return activations;
 }
 
 template<typename T>
-void NeuralNet<T>::backward(const std::vector<Matrix<T>>& activations, const Matrix<T>& target, T learning_rate) {
-  Matrix<T> output = activations.back();
+Matrix<T> NeuralNet<T>::outputDelta(const Matrix<T>& output, MatrixView<const T> target) const {
   Matrix<T> error = output;
   error.subtract(target);
 
   Matrix<T> delta = output;
   delta.apply(activation_derivative_);
   delta.hadamard(error);
+  return delta;
+}
 
-  Matrix<T> prev_activation = activations[activations.size() - 2];
-  Matrix<T> grad_weights = delta.matMul(prev_activation.transpose());
-  Matrix<T> grad_biases = delta;
-
-  grad_weights.multiply(learning_rate);
-  grad_biases.multiply(learning_rate);
-
-  weights_.back().subtract(grad_weights);
-  biases_.back().subtract(grad_biases);
+/* Backpropagates through weights_[last - 1] down to weights_[first]. On entry
+   `delta` is the error signal of activation layer `last`; on return it is the
+   signal of layer `first` (left untouched once layer 0 is reached).
+   activations[j] must hold a_{first + j} for every j < last - first. Each
+   layer is updated before its transpose carries delta one layer down. */
+template<typename T>
+void NeuralNet<T>::backwardRange(std::size_t first, std::size_t last, const std::vector<Matrix<T>>& activations,
+                                 Matrix<T>& delta, T learning_rate) {
+  /* Gradients are averaged over the batch columns. */
+  const T step = learning_rate / static_cast<T>(delta.cols());
 
-  for (std::size_t i = weights_.size() - 2; i < weights_.size(); --i) {
-    Matrix<T> wT = weights_[i + 1].transpose();
-    Matrix<T> new_delta = wT.matMul(delta);
-    Matrix<T> act_deriv = activations[i + 1];
-    act_deriv.apply(activation_derivative_);
-    new_delta.hadamard(act_deriv);
-    delta = new_delta;
+  for (std::size_t i = last; i-- > first;) {
+    const Matrix<T>& prev_activation = activations[i - first];
 
-    Matrix<T> prev_activation = activations[i];
-    Matrix<T> grad_weights = delta.matMul(prev_activation.transpose());
-    Matrix<T> grad_biases = delta;
+    /* Transposes are taken as views, so neither the stored activations nor
+       the weights are copied to form the gradient products. */
+    Matrix<T> grad_weights = delta.matMul(prev_activation.view().transpose());
+    Matrix<T> grad_biases = delta.rowSums();
 
-    grad_weights.multiply(learning_rate);
-    grad_biases.multiply(learning_rate);
+    grad_weights.multiply(step);
+    grad_biases.multiply(step);
 
     weights_[i].subtract(grad_weights);
     biases_[i].subtract(grad_biases);
+
+    if (i > 0) {
+      Matrix<T> new_delta = matMul<T>(weights_[i].view().transpose(), delta);
+      Matrix<T> act_deriv = prev_activation;
+      act_deriv.apply(activation_derivative_);
+      new_delta.hadamard(act_deriv);
+      delta = std::move(new_delta);
+    }
+  }
+}
+
+template<typename T>
+void NeuralNet<T>::backward(const std::vector<Matrix<T>>& activations, MatrixView<const T> target, T learning_rate) {
+  Matrix<T> delta = outputDelta(activations.back(), target);
+  backwardRange(0, weights_.size(), activations, delta, learning_rate);
+}
+
+/* Keeps a_0, a_k, a_2k, ... from the forward pass and rebuilds each segment
+   [jk, (j+1)k) from its checkpoint right before backpropagating through it.
+   Segments are walked from the top, so a segment is always recomputed with
+   weights that have not been updated yet and the result is identical to the
+   plain forward()/backward() path. Costs up to one extra forward pass. */
+template<typename T>
+void NeuralNet<T>::trainCheckpointed(MatrixView<const T> input, MatrixView<const T> target, T learning_rate) {
+  const std::size_t layers = weights_.size();
+  const std::size_t k = static_cast<std::size_t>(checkpoint_interval_);
+
+  std::size_t live_bytes = 0;
+  std::size_t peak_bytes = 0;
+  auto track = [&](const Matrix<T>& m, bool allocated) {
+    std::size_t bytes = sizeof(T) * m.rows() * m.cols();
+    live_bytes = allocated ? live_bytes + bytes : live_bytes - bytes;
+    peak_bytes = std::max(peak_bytes, live_bytes);
+  };
+
+  std::vector<Matrix<T>> checkpoints;
+  Matrix<T> activation(input);
+  track(activation, true);
+  for (std::size_t i = 0; i < layers; ++i) {
+    Matrix<T> next = layerForward(i, activation);
+    track(next, true);
+    if (i % k == 0) {
+      checkpoints.push_back(std::move(activation));
+    } else {
+      track(activation, false);
+    }
+    activation = std::move(next);
+  }
+
+  Matrix<T> delta = outputDelta(activation, target);
+  track(activation, false);
+
+  for (std::size_t s = checkpoints.size(); s-- > 0;) {
+    std::size_t first = s * k;
+    std::size_t last = std::min(first + k, layers);
+
+    std::vector<Matrix<T>> segment;
+    segment.reserve(last - first);
+    segment.push_back(std::move(checkpoints[s]));
+    for (std::size_t i = first; i + 1 < last; ++i) {
+      segment.push_back(layerForward(i, segment.back()));
+      track(segment.back(), true);
+    }
+
+    backwardRange(first, last, segment, delta, learning_rate);
+
+    for (const Matrix<T>& m : segment) {
+      track(m, false);
+    }
   }
+
+  last_train_stats_.peak_activation_bytes = peak_bytes;
 }
 
 template<typename T>
-void NeuralNet<T>::train(const Matrix<T>& input, const Matrix<T>& target, T learning_rate) {
+void NeuralNet<T>::train(MatrixView<const T> input, MatrixView<const T> target, T learning_rate) {
   if (!built_) {
       throw std::runtime_error("Cannot call train(): network has not been built. Call build() first.");
   }
 
+  weights_version_ = detail::nextWeightsVersion();
+  if (checkpoint_interval_ > 1) {
+    trainCheckpointed(input, target, learning_rate);
+    return;
+  }
+
   std::vector<Matrix<T>> activations = forward(input);
+
+  std::size_t bytes = 0;
+  for (const Matrix<T>& m : activations) {
+    bytes += sizeof(T) * m.rows() * m.cols();
+  }
+  last_train_stats_.peak_activation_bytes = bytes;
+
   backward(activations, target, learning_rate);
 }
 
+template<typename T>
+std::size_t NeuralNet<T>::parameterCount() const {
+  std::size_t count = 0;
+  for (const auto* group : {&weights_, &biases_}) {
+    for (const Matrix<T>& m : *group) {
+      count += static_cast<std::size_t>(m.rows()) * m.cols();
+    }
+  }
+  return count;
+}
+
+template<typename T>
+std::vector<T> NeuralNet<T>::parameters() const {
+  std::vector<T> flat;
+  flat.reserve(parameterCount());
+  for (const auto* group : {&weights_, &biases_}) {
+    for (const Matrix<T>& m : *group) {
+      flat.insert(flat.end(), m.data(), m.data() + static_cast<std::size_t>(m.rows()) * m.cols());
+    }
+  }
+  return flat;
+}
+
+template<typename T>
+void NeuralNet<T>::setParameters(const std::vector<T>& parameters) {
+  if (parameters.size() != parameterCount()) {
+    throw std::runtime_error("setParameters(): expected " + std::to_string(parameterCount()) +
+                             " values, got " + std::to_string(parameters.size()));
+  }
+  weights_version_ = detail::nextWeightsVersion();
+  const T* cursor = parameters.data();
+  for (auto* group : {&weights_, &biases_}) {
+    for (Matrix<T>& m : *group) {
+      std::size_t count = static_cast<std::size_t>(m.rows()) * m.cols();
+      std::copy(cursor, cursor + count, m.data());
+      cursor += count;
+    }
+  }
+}
+
+/* Plain backpropagation: unlike train(), which updates each layer before
+   carrying delta through it, every layer's gradient here is taken at the
+   current weights, so gradients from several workers can be combined. */
+template<typename T>
+std::vector<T> NeuralNet<T>::gradients(MatrixView<const T> input, MatrixView<const T> target) const {
+  if (!built_) {
+    throw std::runtime_error("Cannot call gradients(): network has not been built. Call build() first.");
+  }
+
+  std::vector<Matrix<T>> activations = forward(input);
+  Matrix<T> delta = outputDelta(activations.back(), target);
+  const T scale = T(1) / static_cast<T>(delta.cols());
+
+  std::vector<Matrix<T>> grad_weights(weights_.size(), Matrix<T>(0, 0));
+  std::vector<Matrix<T>> grad_biases(biases_.size(), Matrix<T>(0, 0));
+  for (std::size_t i = weights_.size(); i-- > 0;) {
+    grad_weights[i] = delta.matMul(activations[i].view().transpose());
+    grad_biases[i] = delta.rowSums();
+    grad_weights[i].multiply(scale);
+    grad_biases[i].multiply(scale);
+
+    if (i > 0) {
+      Matrix<T> new_delta = matMul<T>(weights_[i].view().transpose(), delta);
+      Matrix<T> act_deriv = activations[i];
+      act_deriv.apply(activation_derivative_);
+      new_delta.hadamard(act_deriv);
+      delta = std::move(new_delta);
+    }
+  }
+
+  std::vector<T> flat;
+  flat.reserve(parameterCount());
+  for (const auto* group : {&grad_weights, &grad_biases}) {
+    for (const Matrix<T>& m : *group) {
+      flat.insert(flat.end(), m.data(), m.data() + static_cast<std::size_t>(m.rows()) * m.cols());
+    }
+  }
+  return flat;
+}
+
+template<typename T>
+void NeuralNet<T>::applyGradients(const std::vector<T>& gradients, T learning_rate) {
+  if (gradients.size() != parameterCount()) {
+    throw std::runtime_error("applyGradients(): expected " + std::to_string(parameterCount()) +
+                             " values, got " + std::to_string(gradients.size()));
+  }
+  weights_version_ = detail::nextWeightsVersion();
+  const T* cursor = gradients.data();
+  for (auto* group : {&weights_, &biases_}) {
+    for (Matrix<T>& m : *group) {
+      T* data = m.data();
+      std::size_t count = static_cast<std::size_t>(m.rows()) * m.cols();
+      for (std::size_t i = 0; i < count; ++i) {
+        data[i] -= learning_rate * cursor[i];
+      }
+      cursor += count;
+    }
+  }
+}
+
+template<typename T>
+void NeuralNet<T>::setCheckpointInterval(int interval) {
+  checkpoint_interval_ = interval > 1 ? interval : 1;
+}
+
+template<typename T>
+int NeuralNet<T>::checkpointInterval() const {
+  return checkpoint_interval_;
+}
+
+template<typename T>
+const typename NeuralNet<T>::TrainStats& NeuralNet<T>::lastTrainStats() const {
+  return last_train_stats_;
+}
+
+template<typename T>
+uint64_t NeuralNet<T>::weightsVersion() const {
+  return weights_version_;
+}
+
 template<typename T>
 void NeuralNet<T>::setActivation(const std::string& type) {
   activation_name_ = type;
+  weights_version_ = detail::nextWeightsVersion();
   using namespace activation;
 
   switch (fromString(type)) {
@@ -200,6 +542,47 @@ void NeuralNet<T>::setLayerSizes(const std::vector<int>& layers) {
   layer_sizes_ = layers;
 }
 
+template<typename T>
+void NeuralNet<T>::setSeed(uint64_t seed) {
+  seed_ = seed;
+  seed_was_set_ = true;
+}
+
+template<typename T>
+void NeuralNet<T>::setThreads(int threads) {
+  threads_ = threads;
+}
+
+template<typename T>
+void NeuralNet<T>::setVerbose(bool verbose) {
+  verbose_ = verbose;
+}
+
+template<typename T>
+uint64_t NeuralNet<T>::seed() const {
+  return seed_;
+}
+
+template<typename T>
+const std::vector<int>& NeuralNet<T>::layerSizes() const {
+  return layer_sizes_;
+}
+
+template<typename T>
+const std::vector<Matrix<T>>& NeuralNet<T>::weights() const {
+  return weights_;
+}
+
+template<typename T>
+const std::vector<Matrix<T>>& NeuralNet<T>::biases() const {
+  return biases_;
+}
+
+template<typename T>
+const std::string& NeuralNet<T>::activationName() const {
+  return activation_name_;
+}
+
 template<typename T>
 void NeuralNet<T>::build() {
   if (layer_sizes_.size() < 2) {
@@ -210,25 +593,87 @@ void NeuralNet<T>::build() {
     setActivation("Sigmoid");
   }
 
+  if (!seed_was_set_) {
+    seed_ = rng::entropySeed();
+  }
+
   weights_.clear();
   biases_.clear();
 
   for (std::size_t i = 0; i < layer_sizes_.size() - 1; ++i) {
     Matrix<T> temp_weights(layer_sizes_[i+1], layer_sizes_[i]);
-    initializer_(temp_weights, layer_sizes_[i], layer_sizes_[i+1]);
-    weights_.push_back(temp_weights);
+    initializer_(temp_weights, layer_sizes_[i], layer_sizes_[i+1],
+                 initializer::layerContext(seed_, i, threads_));
+    weights_.push_back(std::move(temp_weights));
 
     Matrix<T> temp_bias(layer_sizes_[i+1], 1);
     temp_bias.fill(T{});
     biases_.push_back(temp_bias);
   }
 
-  std::cout << "Built NN using activation: " << activation_name_
-            << ", initializer: " << initializer_name_ << "\n";
+  gemm::table().loadDefaultCache();
 
+  if (verbose_) {
+    std::cout << "Built NN using activation: " << activation_name_
+              << ", initializer: " << initializer_name_
+              << ", seed: " << seed_ << "\n";
+  }
+
+  weights_version_ = detail::nextWeightsVersion();
   built_ = true;
 }
 
+template<typename T>
+std::vector<gemm::Shape> NeuralNet<T>::gemmShapes(int batch) const {
+  std::vector<gemm::Shape> shapes;
+  auto add = [&](int m, int n, int k) {
+    gemm::Shape shape{m, n, k, static_cast<int>(sizeof(T))};
+    if (std::find(shapes.begin(), shapes.end(), shape) == shapes.end()) {
+      shapes.push_back(shape);
+    }
+  };
+
+  for (std::size_t i = 0; i + 1 < layer_sizes_.size(); ++i) {
+    const int in = layer_sizes_[i];
+    const int out = layer_sizes_[i + 1];
+    add(out, batch, in);                // W * activation
+    add(out, in, batch);                // delta * activation^T
+    if (i > 0) add(in, batch, out);     // W^T * delta
+  }
+  return shapes;
+}
+
+template<typename T>
+std::vector<gemm::TuneResult> NeuralNet<T>::autotune(int batch, const gemm::TuneOptions& options) {
+  gemm::Table& table = gemm::table();
+  table.loadDefaultCache();
+
+  std::vector<gemm::TuneResult> results;
+  std::vector<std::pair<gemm::Shape, gemm::Config>> tuned;
+  for (const gemm::Shape& shape : gemmShapes(batch)) {
+    std::optional<gemm::Config> known = table.find(shape);
+    if (known && !options.retune) {
+      gemm::TuneResult result;
+      result.shape = shape;
+      result.config = *known;
+      result.cached = true;
+      results.push_back(result);
+      continue;
+    }
+    results.push_back(gemm::tune<T>(shape, options));
+    tuned.emplace_back(shape, results.back().config);
+  }
+  if (tuned.empty()) {
+    return results;
+  }
+
+  table.set(tuned);  // one snapshot for the whole model
+  if (!table.save(gemm::defaultCachePath())) {
+    std::cerr << "Could not write GEMM tuning cache " << gemm::defaultCachePath() << "\n";
+  }
+  return results;
+}
+
 template<typename T>
 void NeuralNet<T>::save(std::string filePath) {
   uint32_t version = 0;
@@ -249,32 +694,24 @@ void NeuralNet<T>::save(std::string filePath) {
   out.write(activation_name_.c_str(), len);
 
   /* Write Weights to binary file. First write rows, cols and then weights.
-  Repeat per weight matrix. */
+  Repeat per weight matrix. The row-major storage is written in one go. */
   for (std::size_t i = 0; i < layer_sizes_.size() - 1; ++i) {
-    Matrix<T> matrix = weights_[i];
+    const Matrix<T>& matrix = weights_[i];
     uint32_t rows = matrix.rows();
     uint32_t cols = matrix.cols();
     out.write(reinterpret_cast<char*>(&rows), sizeof(uint32_t));
     out.write(reinterpret_cast<char*>(&cols), sizeof(uint32_t));
-
-    for (std::size_t j = 0; j < rows * cols; ++j) {
-      T value = matrix.get(j);
-      out.write(reinterpret_cast<char*>(&value), sizeof(T));
-    }
+    out.write(reinterpret_cast<const char*>(matrix.data()), sizeof(T) * rows * cols);
   }
 
   /* Do the same for biases */
   for (std::size_t i = 0; i < biases_.size(); ++i) {
-    Matrix<T> matrix = biases_[i];
+    const Matrix<T>& matrix = biases_[i];
     uint32_t rows = matrix.rows();
     uint32_t cols = matrix.cols();
     out.write(reinterpret_cast<char*>(&rows), sizeof(uint32_t));
     out.write(reinterpret_cast<char*>(&cols), sizeof(uint32_t));
-
-    for (std::size_t j = 0; j < rows * cols; ++j) {
-      T value = matrix.get(j);
-      out.write(reinterpret_cast<char*>(&value), sizeof(T));
-    }
+    out.write(reinterpret_cast<const char*>(matrix.data()), sizeof(T) * rows * cols);
   }
 
   out.close();
@@ -325,15 +762,12 @@ template<typename T>
       in.read(reinterpret_cast<char*>(&cols), sizeof(uint32_t));
 
       Matrix<T> weights(rows, cols);
-      for (std::size_t j = 0; j < rows * cols; ++j) {
-        T value;
-        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+      in.read(reinterpret_cast<char*>(weights.data()), sizeof(T) * rows * cols);
+      weights_.push_back(std::move(weights));
 
-        weights.set(j, value);
+      if (verbose_) {
+        std::cout << "Loaded weight matrix of size: " << rows << "x" << cols << std::endl;
       }
-      weights_.push_back(weights);
-
-      std::cout << "Loaded weight matrix of size: " << rows << "x" << cols << std::endl;
     }
 
     /* Load biases */
@@ -345,18 +779,18 @@ template<typename T>
       in.read(reinterpret_cast<char*>(&cols), sizeof(uint32_t));
 
       Matrix<T> biases(rows, cols);
-      for (std::size_t j = 0; j < rows * cols; ++j) {
-        T value;
-        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+      in.read(reinterpret_cast<char*>(biases.data()), sizeof(T) * rows * cols);
+      biases_.push_back(std::move(biases));
 
-        biases.set(j, value);
+      if (verbose_) {
+        std::cout << "Loaded bias matrix of size: " << rows << "x" << cols << std::endl;
       }
-      biases_.push_back(biases);
-
-      std::cout << "Loaded bias matrix of size: " << rows << "x" << cols << std::endl;
 
     }
     in.close();
+
+    weights_version_ = detail::nextWeightsVersion();
+    gemm::table().loadDefaultCache();
 }
 
 
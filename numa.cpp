@@ -0,0 +1,188 @@
+#include "numa.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace numa {
+
+namespace {
+
+/* From <linux/mempolicy.h>; spelled out to avoid depending on libnuma. */
+constexpr int kMpolBind = 2;
+constexpr int kMpolInterleave = 3;
+constexpr unsigned kMpolMfMove = 1u << 1;
+constexpr int kMaxNodes = 1024;
+constexpr int kBitsPerWord = sizeof(unsigned long) * CHAR_BIT;
+
+std::vector<int> allowedCpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+  }
+  if (cpus.empty()) {
+    long n = ::sysconf(_SC_NPROCESSORS_ONLN);
+    for (int cpu = 0; cpu < std::max(1L, n); ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+bool setPolicy(void* address, std::size_t bytes, int mode, const std::vector<int>& nodes) {
+  std::vector<unsigned long> mask(kMaxNodes / kBitsPerWord, 0);
+  for (int node : nodes) {
+    if (node < 0 || node >= kMaxNodes) return false;
+    mask[node / kBitsPerWord] |= 1ul << (node % kBitsPerWord);
+  }
+  long rc = ::syscall(SYS_mbind, address, bytes, mode, mask.data(),
+                      static_cast<unsigned long>(kMaxNodes), kMpolMfMove);
+  return rc == 0;
+}
+
+}  // namespace
+
+std::vector<int> parseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") continue;
+    std::size_t dash = range.find('-');
+    try {
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    } catch (const std::exception&) {
+      continue;
+    }
+  }
+  return cpus;
+}
+
+Topology Topology::detect() {
+  std::vector<int> allowed = allowedCpus();
+  Topology topology;
+
+  if (DIR* dir = ::opendir("/sys/devices/system/node")) {
+    while (dirent* entry = ::readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+          !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+        continue;
+      }
+
+      std::ifstream in("/sys/devices/system/node/" + name + "/cpulist");
+      std::string list;
+      std::getline(in, list);
+
+      Node node;
+      node.id = std::stoi(name.substr(4));
+      for (int cpu : parseCpuList(list)) {
+        if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+          node.cpus.push_back(cpu);
+        }
+      }
+      if (!node.cpus.empty()) {
+        topology.nodes.push_back(node);
+      }
+    }
+    ::closedir(dir);
+  }
+
+  if (topology.nodes.empty()) {
+    topology.nodes.push_back(Node{0, allowed});
+  }
+  std::sort(topology.nodes.begin(), topology.nodes.end(),
+            [](const Node& a, const Node& b) { return a.id < b.id; });
+  return topology;
+}
+
+std::string Topology::describe() const {
+  std::ostringstream out;
+  out << nodes.size() << " node(s):";
+  for (const Node& node : nodes) {
+    out << " node" << node.id << "[" << node.cpus.size() << " cpus]";
+  }
+  return out.str();
+}
+
+bool pinThisThread(int cpu) {
+  return pinThisThread(std::vector<int>{cpu});
+}
+
+bool pinThisThread(const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+  }
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+}
+
+std::size_t pageSize() {
+  static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+void* allocatePages(std::size_t bytes) {
+  void* address = ::mmap(nullptr, std::max<std::size_t>(bytes, 1), PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (address == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  return address;
+}
+
+void freePages(void* address, std::size_t bytes) {
+  if (address) {
+    ::munmap(address, std::max<std::size_t>(bytes, 1));
+  }
+}
+
+bool bindToNode(void* address, std::size_t bytes, int node) {
+  return setPolicy(address, bytes, kMpolBind, {node});
+}
+
+bool interleave(void* address, std::size_t bytes, const std::vector<int>& nodes) {
+  return setPolicy(address, bytes, kMpolInterleave, nodes);
+}
+
+std::vector<std::size_t> pagesPerNode(const void* address, std::size_t bytes) {
+  const std::size_t page = pageSize();
+  const char* start = static_cast<const char*>(address);
+  std::size_t count = (bytes + page - 1) / page;
+
+  std::vector<void*> pages(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    pages[i] = const_cast<char*>(start + i * page);
+  }
+  std::vector<int> status(count, -1);
+
+  long rc = ::syscall(SYS_move_pages, 0, count, pages.data(), nullptr, status.data(), 0);
+  if (rc != 0) {
+    return {};
+  }
+
+  std::vector<std::size_t> histogram;
+  for (int node : status) {
+    if (node < 0) continue;
+    if (static_cast<std::size_t>(node) >= histogram.size()) histogram.resize(node + 1, 0);
+    ++histogram[node];
+  }
+  return histogram;
+}
+
+}  // namespace numa
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* Linux NUMA helpers built on sysfs and raw syscalls, so no libnuma is
+   needed. Every function degrades gracefully: on a single-node machine or
+   where the kernel refuses a policy call they report failure (false / empty)
+   and callers fall back to first-touch placement. */
+namespace numa {
+
+struct Node {
+  int id = 0;
+  std::vector<int> cpus;  // CPUs of this node that the process may run on
+};
+
+struct Topology {
+  std::vector<Node> nodes;
+
+  /* Reads /sys/devices/system/node. Falls back to one node holding every
+     CPU in the process' affinity mask. */
+  static Topology detect();
+
+  std::size_t size() const { return nodes.size(); }
+  std::string describe() const;
+};
+
+/* Parses a sysfs CPU list such as "0-3,8-11". */
+std::vector<int> parseCpuList(const std::string& list);
+
+/* Restricts the calling thread to one CPU / to a set of CPUs. */
+bool pinThisThread(int cpu);
+bool pinThisThread(const std::vector<int>& cpus);
+
+/* Anonymous, page-aligned mapping that is not touched (so no page is placed
+   until first write or an explicit policy). */
+void* allocatePages(std::size_t bytes);
+void freePages(void* address, std::size_t bytes);
+std::size_t pageSize();
+
+/* mbind(2) wrappers. Pages already touched are migrated (MPOL_MF_MOVE). */
+bool bindToNode(void* address, std::size_t bytes, int node);
+bool interleave(void* address, std::size_t bytes, const std::vector<int>& nodes);
+
+/* Number of pages of [address, address + bytes) resident on each node id,
+   via move_pages(2) in query mode. Empty if the kernel does not support it. */
+std::vector<std::size_t> pagesPerNode(const void* address, std::size_t bytes);
+
+}  // namespace numa
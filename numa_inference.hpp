@@ -0,0 +1,371 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "activation.hpp"
+#include "matrix.hpp"
+#include "neuralnetwork.hpp"
+#include "numa.hpp"
+#include "parallel.hpp"
+
+namespace numa {
+
+enum class Placement {
+  REPLICATE,    // one copy of the weights per worker node, each node-local
+  INTERLEAVE,   // one copy, pages spread round-robin over all nodes
+  SINGLE_NODE,  // one copy on Options::weights_node (local/remote baselines)
+};
+
+struct Options {
+  Placement placement = Placement::REPLICATE;
+  int weights_node = 0;           // SINGLE_NODE: node id holding the copy
+  std::vector<int> worker_nodes;  // node ids to run workers on; empty = all
+  int threads_per_node = 0;       // <= 0: one worker per CPU of the node
+};
+
+/* Multi-socket inference for a trained NeuralNet.
+
+   Workers are pinned one per CPU. The weights are copied into page-aligned
+   buffers placed according to Options::placement: with mbind(2) when the
+   kernel allows it, and always by first touch from a thread running on the
+   target node, so placement holds even without NUMA policy support. In
+   REPLICATE mode every worker reads the replica of its own node, so each
+   thread's share of the GEMM work only touches node-local weights.
+
+   predict() splits the batch columns evenly across the workers. */
+template<typename T>
+class Executor {
+public:
+  explicit Executor(const NeuralNet<T>& net, Options options = Options());
+  ~Executor();
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  Matrix<T> predict(MatrixView<const T> input);
+
+  const Topology& topology() const { return topology_; }
+  std::size_t workerCount() const { return workers_.size(); }
+
+  /* For each copy of the weights: its home node (-1 when interleaved) and
+     how many of its pages currently sit on each node id. */
+  struct CopyPlacement {
+    int node;
+    std::vector<std::size_t> pages_per_node;
+  };
+  std::vector<CopyPlacement> placement() const;
+
+private:
+  /* Owns its pages, so replicas mapped before a constructor failure are
+     released along with replicas_. */
+  struct Replica {
+    T* base = nullptr;
+    std::size_t bytes = 0;
+    int node = -1;
+    std::vector<MatrixView<const T>> weights;
+    std::vector<MatrixView<const T>> biases;
+
+    Replica() = default;
+    ~Replica() { freePages(base, bytes); }
+    Replica(Replica&& other) noexcept
+      : base(std::exchange(other.base, nullptr)), bytes(std::exchange(other.bytes, 0)), node(other.node),
+        weights(std::move(other.weights)), biases(std::move(other.biases)) {}
+    Replica& operator=(Replica&& other) noexcept {
+      if (this != &other) {
+        freePages(base, bytes);
+        base = std::exchange(other.base, nullptr);
+        bytes = std::exchange(other.bytes, 0);
+        node = other.node;
+        weights = std::move(other.weights);
+        biases = std::move(other.biases);
+      }
+      return *this;
+    }
+    Replica(const Replica&) = delete;
+    Replica& operator=(const Replica&) = delete;
+  };
+
+  struct Worker {
+    int cpu;
+    std::size_t replica;
+    std::thread thread;
+  };
+
+  const Node& nodeById(int id) const;
+  void buildReplicas(const NeuralNet<T>& net);
+  void fillReplica(Replica& replica, const NeuralNet<T>& net);
+  void workerLoop(std::size_t index);
+
+  Topology topology_;
+  Options options_;
+  std::function<T(T)> activation_;
+  int output_size_ = 0;
+  std::vector<Replica> replicas_;
+  std::vector<Worker> workers_;
+
+  /* One job at a time: predict() publishes it under mutex_, bumps
+     generation_ and waits until every worker has finished its share. */
+  std::mutex predict_mutex_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  unsigned long generation_ = 0;
+  std::size_t pending_ = 0;
+  bool shutdown_ = false;
+  MatrixView<const T> job_input_{nullptr, 0, 0};
+  MatrixView<T> job_output_{nullptr, 0, 0};
+  std::exception_ptr job_error_;
+};
+
+/* Implementations */
+namespace detail {
+
+inline std::size_t alignTo(std::size_t bytes, std::size_t alignment) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+/* Runs fn on a temporary thread restricted to the CPUs of `node`, so the
+   pages it writes first are allocated on that node. */
+template<typename Fn>
+void runOnNode(const Node& node, Fn&& fn) {
+  std::exception_ptr error;
+  std::thread thread([&] {
+    pinThisThread(node.cpus);
+    try {
+      fn();
+    } catch (...) {
+      error = std::current_exception();
+    }
+  });
+  thread.join();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace detail
+
+template<typename T>
+Executor<T>::Executor(const NeuralNet<T>& net, Options options)
+  : topology_(Topology::detect()), options_(std::move(options)) {
+  if (net.weights().empty()) {
+    throw std::runtime_error("numa::Executor needs a built or loaded network.");
+  }
+  activation_ = activation::function<T>(activation::fromString(net.activationName()));
+  output_size_ = net.layerSizes().back();
+
+  if (options_.worker_nodes.empty()) {
+    for (const Node& node : topology_.nodes) options_.worker_nodes.push_back(node.id);
+  }
+
+  buildReplicas(net);
+
+  /* Workers: CPUs of each selected node, in node order. */
+  for (int id : options_.worker_nodes) {
+    const Node& node = nodeById(id);
+    std::size_t replica = 0;
+    if (options_.placement == Placement::REPLICATE) {
+      for (std::size_t r = 0; r < replicas_.size(); ++r) {
+        if (replicas_[r].node == id) replica = r;
+      }
+    }
+    int count = options_.threads_per_node > 0
+        ? std::min<int>(options_.threads_per_node, static_cast<int>(node.cpus.size()))
+        : static_cast<int>(node.cpus.size());
+    for (int i = 0; i < count; ++i) {
+      workers_.push_back(Worker{node.cpus[i], replica, std::thread()});
+    }
+  }
+  for (std::size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i].thread = std::thread(&Executor::workerLoop, this, i);
+  }
+}
+
+template<typename T>
+Executor<T>::~Executor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  start_cv_.notify_all();
+  for (Worker& worker : workers_) {
+    worker.thread.join();
+  }
+}
+
+template<typename T>
+const Node& Executor<T>::nodeById(int id) const {
+  for (const Node& node : topology_.nodes) {
+    if (node.id == id) return node;
+  }
+  throw std::runtime_error("No usable CPUs on NUMA node " + std::to_string(id));
+}
+
+template<typename T>
+void Executor<T>::buildReplicas(const NeuralNet<T>& net) {
+  std::size_t bytes = 0;
+  for (const auto* group : {&net.weights(), &net.biases()}) {
+    for (const Matrix<T>& m : *group) {
+      bytes += detail::alignTo(sizeof(T) * m.rows() * m.cols(), 64);
+    }
+  }
+  bytes = detail::alignTo(bytes, pageSize());
+
+  /* Reject unusable node ids before mapping anything. */
+  for (int id : options_.worker_nodes) nodeById(id);
+  if (options_.placement == Placement::SINGLE_NODE) nodeById(options_.weights_node);
+
+  auto allocate = [&](int node) {
+    Replica replica;
+    replica.base = static_cast<T*>(allocatePages(bytes));
+    replica.bytes = bytes;
+    replica.node = node;
+    replicas_.push_back(std::move(replica));
+    return &replicas_.back();
+  };
+
+  switch (options_.placement) {
+    case Placement::REPLICATE:
+      replicas_.reserve(options_.worker_nodes.size());
+      for (int id : options_.worker_nodes) {
+        Replica* replica = allocate(id);
+        bindToNode(replica->base, bytes, id);
+        detail::runOnNode(nodeById(id), [&] { fillReplica(*replica, net); });
+      }
+      break;
+
+    case Placement::SINGLE_NODE: {
+      Replica* replica = allocate(options_.weights_node);
+      bindToNode(replica->base, bytes, options_.weights_node);
+      detail::runOnNode(nodeById(options_.weights_node), [&] { fillReplica(*replica, net); });
+      break;
+    }
+
+    case Placement::INTERLEAVE: {
+      Replica* replica = allocate(-1);
+      std::vector<int> ids;
+      for (const Node& node : topology_.nodes) ids.push_back(node.id);
+
+      /* Without an interleave policy, place page p on node p % N by having
+         a thread on that node touch it first. */
+      if (!interleave(replica->base, bytes, ids)) {
+        const std::size_t page = pageSize();
+        for (std::size_t n = 0; n < topology_.nodes.size(); ++n) {
+          detail::runOnNode(topology_.nodes[n], [&] {
+            char* base = reinterpret_cast<char*>(replica->base);
+            for (std::size_t p = n; p * page < bytes; p += topology_.nodes.size()) {
+              base[p * page] = 0;
+            }
+          });
+        }
+      }
+      fillReplica(*replica, net);
+      break;
+    }
+  }
+}
+
+template<typename T>
+void Executor<T>::fillReplica(Replica& replica, const NeuralNet<T>& net) {
+  char* cursor = reinterpret_cast<char*>(replica.base);
+  auto copy = [&](const Matrix<T>& m) {
+    std::size_t bytes = sizeof(T) * m.rows() * m.cols();
+    std::memcpy(cursor, m.data(), bytes);
+    MatrixView<const T> view(reinterpret_cast<const T*>(cursor), m.rows(), m.cols());
+    cursor += detail::alignTo(bytes, 64);
+    return view;
+  };
+
+  replica.weights.clear();
+  replica.biases.clear();
+  for (const Matrix<T>& m : net.weights()) replica.weights.push_back(copy(m));
+  for (const Matrix<T>& m : net.biases()) replica.biases.push_back(copy(m));
+}
+
+template<typename T>
+Matrix<T> Executor<T>::predict(MatrixView<const T> input) {
+  std::lock_guard<std::mutex> serial(predict_mutex_);
+  Matrix<T> output(output_size_, input.cols());
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_input_ = input;
+    job_output_ = output.view();
+    job_error_ = nullptr;
+    pending_ = workers_.size();
+    ++generation_;
+  }
+  start_cv_.notify_all();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [&] { return pending_ == 0; });
+  if (job_error_) {
+    std::rethrow_exception(job_error_);
+  }
+  return output;
+}
+
+template<typename T>
+void Executor<T>::workerLoop(std::size_t index) {
+  pinThisThread(workers_[index].cpu);
+  parallel::Region region;  // spawned threads would inherit the single-CPU mask
+  const Replica& replica = replicas_[workers_[index].replica];
+  unsigned long seen = 0;
+
+  for (;;) {
+    MatrixView<const T> input{nullptr, 0, 0};
+    MatrixView<T> output{nullptr, 0, 0};
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&] { return shutdown_ || generation_ != seen; });
+      if (shutdown_) return;
+      seen = generation_;
+      input = job_input_;
+      output = job_output_;
+    }
+
+    try {
+      std::size_t workers = workers_.size();
+      int first = static_cast<int>(input.cols() * index / workers);
+      int last = static_cast<int>(input.cols() * (index + 1) / workers);
+      if (last > first) {
+        Matrix<T> result = forwardLayers<T>(replica.weights, replica.biases, activation_,
+                                            input.block(0, first, input.rows(), last - first));
+        MatrixView<T> target = output.block(0, first, output.rows(), last - first);
+        for (int r = 0; r < result.rows(); ++r) {
+          for (int c = 0; c < result.cols(); ++c) {
+            target(r, c) = result.get(r, c);
+          }
+        }
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!job_error_) job_error_ = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+template<typename T>
+std::vector<typename Executor<T>::CopyPlacement> Executor<T>::placement() const {
+  std::vector<CopyPlacement> result;
+  for (const Replica& replica : replicas_) {
+    result.push_back(CopyPlacement{replica.node, pagesPerNode(replica.base, replica.bytes)});
+  }
+  return result;
+}
+
+}  // namespace numa
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+inline int hardwareThreads() {
+  unsigned int n = std::thread::hardware_concurrency();
+  return n > 0 ? static_cast<int>(n) : 1;
+}
+
+/* 0 (or any non-positive value) means "use every hardware thread". */
+inline int resolveThreads(int threads) {
+  return threads > 0 ? threads : hardwareThreads();
+}
+
+namespace detail {
+
+inline int& regionDepth() {
+  thread_local int depth = 0;
+  return depth;
+}
+
+}  // namespace detail
+
+/* Marks the current thread, for the guard's lifetime, as one of several
+   already running in parallel. Kernels that would split their own work
+   across threads (the tuned GEMM thread split) check inRegion() and stay on
+   the calling thread instead of oversubscribing the machine. forRange()
+   marks its chunks; code that spawns its own worker threads should hold a
+   Region in each of them. */
+class Region {
+public:
+  Region() { ++detail::regionDepth(); }
+  ~Region() { --detail::regionDepth(); }
+
+  Region(const Region&) = delete;
+  Region& operator=(const Region&) = delete;
+};
+
+inline bool inRegion() {
+  return detail::regionDepth() > 0;
+}
+
+/* Splits [0, count) into contiguous chunks of at least `grain` items and runs
+   fn(begin, end) on each, one chunk per thread. The calling thread takes the
+   first chunk, so threads == 1 (or a small count) never spawns anything.
+   The first exception thrown by any chunk is rethrown after all chunks end. */
+template<typename Fn>
+void forRange(std::size_t count, int threads, Fn&& fn, std::size_t grain = 1) {
+  if (count == 0) {
+    return;
+  }
+
+  grain = std::max<std::size_t>(grain, 1);
+  std::size_t max_chunks = (count + grain - 1) / grain;
+  std::size_t chunks = std::min<std::size_t>(static_cast<std::size_t>(resolveThreads(threads)), max_chunks);
+
+  if (chunks <= 1) {
+    fn(std::size_t{0}, count);
+    return;
+  }
+
+  std::size_t per_chunk = count / chunks;
+  std::size_t remainder = count % chunks;
+  std::vector<std::exception_ptr> errors(chunks);
+  std::vector<std::thread> workers;
+  workers.reserve(chunks - 1);
+
+  auto run = [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+    Region region;
+    try {
+      fn(begin, end);
+    } catch (...) {
+      errors[chunk] = std::current_exception();
+    }
+  };
+
+  std::size_t begin = per_chunk + (remainder > 0 ? 1 : 0);
+  std::size_t first_end = begin;
+  for (std::size_t c = 1; c < chunks; ++c) {
+    std::size_t end = begin + per_chunk + (c < remainder ? 1 : 0);
+    workers.emplace_back(run, c, begin, end);
+    begin = end;
+  }
+  run(0, 0, first_end);
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+}  // namespace parallel
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "matrix.hpp"
+#include "neuralnetwork.hpp"
+
+namespace detail {
+
+inline uint64_t mix64(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDull;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+/* Fast non-cryptographic 64-bit hash: one multiply-rotate round per 8-byte
+   word and a murmur3 finalizer. Hashes the bytes, so -0.0 and 0.0 differ. */
+inline uint64_t hashBytes(const void* data, std::size_t size, uint64_t seed = 0) {
+  constexpr uint64_t k1 = 0x9E3779B97F4A7C15ull;
+  constexpr uint64_t k2 = 0xC2B2AE3D27D4EB4Full;
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint64_t h = seed ^ (size * k1);
+
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    h ^= word * k1;
+    h = ((h << 31) | (h >> 33)) * k2;
+  }
+  if (i < size) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes + i, size - i);
+    h ^= word * k1;
+    h = ((h << 31) | (h >> 33)) * k2;
+  }
+  return mix64(h);
+}
+
+}  // namespace detail
+
+/* Thread-safe LRU cache of per-sample predict() results.
+
+   Every input column is keyed by a 64-bit hash of its values and confirmed
+   with a full compare, so a hash collision is a miss, never a wrong answer.
+   The misses of a batch are predicted together in one NeuralNet::predict()
+   call; since every GEMM path sums in the same order, cached and fresh
+   outputs are bit-identical to an uncached predict() of the whole batch.
+
+   Entries are spread over independently locked shards, each holding an
+   equal slice of the memory budget and evicting its least recently used
+   entries to stay inside it. A shard drops everything it holds whenever it
+   sees a different NeuralNet::weightsVersion(), so train(), load(),
+   assigning an older copy of the network and friends invalidate the cache
+   without telling it. Training the network
+   while another thread predicts through the cache is not supported, just
+   as with NeuralNet::predict() itself. */
+template<typename T>
+class PredictionCache {
+public:
+  struct Stats {
+    std::size_t hits = 0;           // columns answered from the cache
+    std::size_t misses = 0;         // columns that went to predict()
+    std::size_t evictions = 0;      // entries dropped to stay inside the budget
+    std::size_t invalidations = 0;  // entries dropped because the weights changed
+    std::size_t entries = 0;
+    std::size_t bytes = 0;          // approximate, counted against the budget
+
+    double hitRate() const {
+      std::size_t lookups = hits + misses;
+      return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+  };
+
+  /* threads is passed on to predict() for the misses (1 = calling thread,
+     <= 0 = every core). */
+  PredictionCache(const NeuralNet<T>& net, std::size_t budget_bytes, int shards = 16, int threads = 1);
+
+  PredictionCache(const PredictionCache&) = delete;
+  PredictionCache& operator=(const PredictionCache&) = delete;
+
+  Matrix<T> predict(MatrixView<const T> input);
+
+  Stats stats() const;
+  void resetStats();
+  void clear();
+
+  std::size_t budgetBytes() const { return budget_bytes_; }
+  int shardCount() const { return shard_count_; }
+
+private:
+  /* data holds the input column followed by the output column. */
+  struct Entry {
+    uint64_t hash;
+    std::vector<T> data;
+  };
+  using List = std::list<Entry>;
+
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    List lru;  // most recently used first
+    std::unordered_map<uint64_t, typename List::iterator> index;
+    std::size_t bytes = 0;
+    uint64_t version = 0;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t invalidations = 0;
+  };
+
+  /* List and hash-table node overhead per entry, counted against the budget. */
+  static constexpr std::size_t kEntryOverhead = sizeof(Entry) + 64;
+
+  Shard& shardFor(uint64_t hash) { return shards_[(hash >> 32) % static_cast<uint64_t>(shard_count_)]; }
+  std::size_t entryBytes() const { return kEntryOverhead + (input_size_ + output_size_) * sizeof(T); }
+  void syncVersion(Shard& shard, uint64_t version);
+  void erase(Shard& shard, typename List::iterator entry);
+
+  const NeuralNet<T>& net_;
+  std::size_t budget_bytes_;
+  std::size_t shard_budget_;
+  int shard_count_;
+  int threads_;
+  std::size_t input_size_;
+  std::size_t output_size_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+/* Implementations */
+
+template<typename T>
+PredictionCache<T>::PredictionCache(const NeuralNet<T>& net, std::size_t budget_bytes, int shards, int threads)
+  : net_(net),
+    budget_bytes_(budget_bytes),
+    shard_count_(shards > 0 ? shards : 1),
+    threads_(threads) {
+  if (net.layerSizes().size() < 2) {
+    throw std::runtime_error("PredictionCache needs a network with layer sizes set.");
+  }
+  input_size_ = static_cast<std::size_t>(net.layerSizes().front());
+  output_size_ = static_cast<std::size_t>(net.layerSizes().back());
+  shard_budget_ = budget_bytes_ / static_cast<std::size_t>(shard_count_);
+  shards_.reset(new Shard[shard_count_]);
+}
+
+template<typename T>
+void PredictionCache<T>::erase(Shard& shard, typename List::iterator entry) {
+  shard.index.erase(entry->hash);
+  shard.lru.erase(entry);
+  shard.bytes -= entryBytes();
+}
+
+/* Any change of version means the weights changed since the shard last
+   looked. It can go down as well as up: copy-assigning an older snapshot
+   of the network brings back that snapshot's version. */
+template<typename T>
+void PredictionCache<T>::syncVersion(Shard& shard, uint64_t version) {
+  if (shard.version == version) return;
+  shard.invalidations += shard.lru.size();
+  shard.lru.clear();
+  shard.index.clear();
+  shard.bytes = 0;
+  shard.version = version;
+}
+
+template<typename T>
+Matrix<T> PredictionCache<T>::predict(MatrixView<const T> input) {
+  if (static_cast<std::size_t>(input.rows()) != input_size_) {
+    throw std::runtime_error("PredictionCache::predict(): expected " + std::to_string(input_size_) +
+                             " input rows, got " + std::to_string(input.rows()));
+  }
+  const uint64_t version = net_.weightsVersion();
+  const int cols = input.cols();
+  Matrix<T> output(static_cast<int>(output_size_), cols);
+
+  /* Columns gathered contiguously: the cache keys, and later the batch of
+     misses handed to predict(). */
+  std::vector<T> keys(input_size_ * cols);
+  std::vector<uint64_t> hashes(cols);
+  std::vector<int> missed;
+
+  for (int j = 0; j < cols; ++j) {
+    T* key = keys.data() + input_size_ * j;
+    for (std::size_t i = 0; i < input_size_; ++i) {
+      key[i] = input(static_cast<int>(i), j);
+    }
+    hashes[j] = detail::hashBytes(key, input_size_ * sizeof(T));
+
+    Shard& shard = shardFor(hashes[j]);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    syncVersion(shard, version);
+    auto found = shard.index.find(hashes[j]);
+    if (found != shard.index.end() &&
+        std::memcmp(found->second->data.data(), key, input_size_ * sizeof(T)) == 0) {
+      shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+      const T* value = found->second->data.data() + input_size_;
+      for (std::size_t r = 0; r < output_size_; ++r) {
+        output.set(static_cast<int>(r), j, value[r]);
+      }
+      ++shard.hits;
+    } else {
+      missed.push_back(j);
+      ++shard.misses;
+    }
+  }
+
+  if (missed.empty()) {
+    return output;
+  }
+
+  Matrix<T> batch(static_cast<int>(input_size_), static_cast<int>(missed.size()));
+  for (std::size_t m = 0; m < missed.size(); ++m) {
+    const T* key = keys.data() + input_size_ * missed[m];
+    for (std::size_t i = 0; i < input_size_; ++i) {
+      batch.set(static_cast<int>(i), static_cast<int>(m), key[i]);
+    }
+  }
+  Matrix<T> fresh = threads_ == 1 ? net_.predict(batch) : net_.predict(batch, threads_);
+
+  const std::size_t bytes = entryBytes();
+  for (std::size_t m = 0; m < missed.size(); ++m) {
+    const int j = missed[m];
+    for (std::size_t r = 0; r < output_size_; ++r) {
+      output.set(static_cast<int>(r), j, fresh.get(static_cast<int>(r), static_cast<int>(m)));
+    }
+    if (bytes > shard_budget_) continue;
+
+    Shard& shard = shardFor(hashes[j]);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    /* The lookup above synced this shard; if another caller has moved it to
+       other weights since, these outputs are stale there. */
+    if (shard.version != version) continue;
+
+    auto found = shard.index.find(hashes[j]);
+    if (found != shard.index.end()) {
+      erase(shard, found->second);  // same input seen twice in this batch, or a collision
+    }
+    Entry entry{hashes[j], std::vector<T>(input_size_ + output_size_)};
+    std::copy(keys.begin() + input_size_ * j, keys.begin() + input_size_ * (j + 1), entry.data.begin());
+    for (std::size_t r = 0; r < output_size_; ++r) {
+      entry.data[input_size_ + r] = fresh.get(static_cast<int>(r), static_cast<int>(m));
+    }
+    shard.lru.push_front(std::move(entry));
+    shard.index.emplace(hashes[j], shard.lru.begin());
+    shard.bytes += bytes;
+
+    while (shard.bytes > shard_budget_) {
+      erase(shard, std::prev(shard.lru.end()));
+      ++shard.evictions;
+    }
+  }
+  return output;
+}
+
+template<typename T>
+typename PredictionCache<T>::Stats PredictionCache<T>::stats() const {
+  Stats total;
+  for (int s = 0; s < shard_count_; ++s) {
+    Shard& shard = shards_[s];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    total.hits += shard.hits;
+    total.misses += shard.misses;
+    total.evictions += shard.evictions;
+    total.invalidations += shard.invalidations;
+    total.entries += shard.lru.size();
+    total.bytes += shard.bytes;
+  }
+  return total;
+}
+
+template<typename T>
+void PredictionCache<T>::resetStats() {
+  for (int s = 0; s < shard_count_; ++s) {
+    Shard& shard = shards_[s];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.hits = shard.misses = shard.evictions = shard.invalidations = 0;
+  }
+}
+
+template<typename T>
+void PredictionCache<T>::clear() {
+  for (int s = 0; s < shard_count_; ++s) {
+    Shard& shard = shards_[s];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.lru.clear();
+    shard.index.clear();
+    shard.bytes = 0;
+  }
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+#include "parallel.hpp"
+
+namespace rng {
+
+/* Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random
+   Numbers: As Easy as 1, 2, 3"). There is no state to advance: block n of a
+   stream is a pure function of (key, counter), so any thread can produce any
+   part of a sequence and the result never depends on how work was split. */
+class Philox4x32 {
+public:
+  using Block = std::array<uint32_t, 4>;
+
+  static Block generate(uint64_t key, uint64_t counter_lo, uint64_t counter_hi) {
+    uint32_t k0 = static_cast<uint32_t>(key);
+    uint32_t k1 = static_cast<uint32_t>(key >> 32);
+    Block c = {static_cast<uint32_t>(counter_lo), static_cast<uint32_t>(counter_lo >> 32),
+               static_cast<uint32_t>(counter_hi), static_cast<uint32_t>(counter_hi >> 32)};
+
+    for (int round = 0; round < 10; ++round) {
+      uint64_t p0 = static_cast<uint64_t>(kMul0) * c[0];
+      uint64_t p1 = static_cast<uint64_t>(kMul1) * c[2];
+      c = {static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0, static_cast<uint32_t>(p1),
+           static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1, static_cast<uint32_t>(p0)};
+      k0 += kWeyl0;
+      k1 += kWeyl1;
+    }
+    return c;
+  }
+
+private:
+  static constexpr uint32_t kMul0 = 0xD2511F53u;
+  static constexpr uint32_t kMul1 = 0xCD9E8D57u;
+  static constexpr uint32_t kWeyl0 = 0x9E3779B9u;
+  static constexpr uint32_t kWeyl1 = 0xBB67AE85u;
+};
+
+/* One independent random sequence: `seed` is the Philox key, `id` selects the
+   sequence (e.g. the layer index) and block n yields four 32-bit values. */
+struct Stream {
+  uint64_t seed = 0;
+  uint64_t id = 0;
+
+  Philox4x32::Block block(uint64_t index) const {
+    return Philox4x32::generate(seed, index, id);
+  }
+};
+
+/* A fresh seed for callers that did not ask for reproducibility. The device
+   is read once per process; later calls are decorrelated with splitmix64. */
+inline uint64_t entropySeed() {
+  static const uint64_t base = [] {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+  }();
+  static std::atomic<uint64_t> calls{0};
+
+  uint64_t z = base + 0x9E3779B97F4A7C15ull * (calls.fetch_add(1) + 1);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+/* Maps 32 random bits to [0, 1). float keeps 24 bits so the value can never
+   round up to 1; wider types use all 32. */
+template<typename T>
+inline T toUnit(uint32_t bits) {
+  if constexpr (std::is_same<T, float>::value) {
+    return static_cast<float>(bits >> 8) * (1.0f / 16777216.0f);
+  } else {
+    return static_cast<T>(bits) * static_cast<T>(1.0 / 4294967296.0);
+  }
+}
+
+namespace detail {
+
+/* Elements are produced four at a time (one Philox block). Each thread gets
+   at least this many blocks, so small layers are filled inline. */
+constexpr std::size_t kBlocksPerTask = 1 << 14;
+
+template<typename T, typename BlockFn>
+void fillBlocks(T* data, std::size_t n, int threads, BlockFn&& make_block) {
+  std::size_t blocks = (n + 3) / 4;
+  parallel::forRange(blocks, threads, [&](std::size_t first, std::size_t last) {
+    T values[4];
+    for (std::size_t b = first; b < last; ++b) {
+      make_block(b, values);
+      std::size_t base = b * 4;
+      std::size_t count = base + 4 <= n ? 4 : n - base;
+      for (std::size_t i = 0; i < count; ++i) {
+        data[base + i] = values[i];
+      }
+    }
+  }, kBlocksPerTask);
+}
+
+}  // namespace detail
+
+/* Fills data[0, n) with values uniform in [min, max) ([min, max] for integral
+   T). Element i always comes from block i / 4 of the stream, so the output is
+   bit-identical for any thread count. threads <= 0 uses every core. */
+template<typename T>
+void fillUniform(T* data, std::size_t n, const Stream& stream, T min, T max, int threads = 0) {
+  static_assert(std::is_arithmetic<T>::value, "fillUniform() requires an arithmetic type");
+
+  detail::fillBlocks(data, n, threads, [&](std::size_t b, T (&out)[4]) {
+    auto bits = stream.block(b);
+    for (int i = 0; i < 4; ++i) {
+      if constexpr (std::is_integral<T>::value) {
+        uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(max) - static_cast<int64_t>(min)) + 1;
+        out[i] = static_cast<T>(static_cast<int64_t>(min) + static_cast<int64_t>(bits[i] % span));
+      } else {
+        out[i] = min + (max - min) * toUnit<T>(bits[i]);
+      }
+    }
+  });
+}
+
+/* Fills data[0, n) with N(mean, stddev) samples via Box-Muller, two normals
+   per pair of 32-bit values. Same determinism guarantee as fillUniform. */
+template<typename T>
+void fillNormal(T* data, std::size_t n, const Stream& stream, T mean, T stddev, int threads = 0) {
+  static_assert(std::is_floating_point<T>::value, "fillNormal() requires a floating-point type");
+
+  detail::fillBlocks(data, n, threads, [&](std::size_t b, T (&out)[4]) {
+    auto bits = stream.block(b);
+    for (int i = 0; i < 4; i += 2) {
+      /* u1 is in (0, 1] so the logarithm is always finite. */
+      double u1 = (static_cast<double>(bits[i]) + 1.0) * (1.0 / 4294967296.0);
+      double u2 = static_cast<double>(bits[i + 1]) * (1.0 / 4294967296.0);
+      double r = std::sqrt(-2.0 * std::log(u1));
+      double theta = 6.283185307179586 * u2;
+      out[i] = mean + stddev * static_cast<T>(r * std::cos(theta));
+      out[i + 1] = mean + stddev * static_cast<T>(r * std::sin(theta));
+    }
+  });
+}
+
+}  // namespace rng
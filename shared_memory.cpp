@@ -0,0 +1,108 @@
+#include "shared_memory.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+[[noreturn]] void fail(const std::string& what) {
+  throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+}  // namespace
+
+SharedMemory::~SharedMemory() {
+  release();
+}
+
+SharedMemory::SharedMemory(SharedMemory&& other) noexcept
+  : name_(std::move(other.name_)), data_(other.data_), size_(other.size_), owner_(other.owner_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.owner_ = false;
+}
+
+SharedMemory& SharedMemory::operator=(SharedMemory&& other) noexcept {
+  if (this != &other) {
+    release();
+    name_ = std::move(other.name_);
+    data_ = other.data_;
+    size_ = other.size_;
+    owner_ = other.owner_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.owner_ = false;
+  }
+  return *this;
+}
+
+SharedMemory SharedMemory::create(const std::string& name, std::size_t size) {
+  int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    fail("shm_open(" + name + ")");
+  }
+  if (::ftruncate(fd, static_cast<off_t>(size)) < 0) {
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    fail("ftruncate(" + name + ")");
+  }
+
+  void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    ::shm_unlink(name.c_str());
+    fail("mmap(" + name + ")");
+  }
+
+  SharedMemory shm;
+  shm.name_ = name;
+  shm.data_ = data;
+  shm.size_ = size;
+  shm.owner_ = true;
+  return shm;
+}
+
+SharedMemory SharedMemory::attach(const std::string& name, bool writable) {
+  int fd = ::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+  if (fd < 0) {
+    fail("shm_open(" + name + ")");
+  }
+
+  struct stat info;
+  if (::fstat(fd, &info) < 0) {
+    ::close(fd);
+    fail("fstat(" + name + ")");
+  }
+
+  std::size_t size = static_cast<std::size_t>(info.st_size);
+  void* data = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    fail("mmap(" + name + ")");
+  }
+
+  SharedMemory shm;
+  shm.name_ = name;
+  shm.data_ = data;
+  shm.size_ = size;
+  return shm;
+}
+
+void SharedMemory::release() {
+  if (data_) {
+    ::munmap(data_, size_);
+  }
+  if (owner_) {
+    ::shm_unlink(name_.c_str());
+  }
+  data_ = nullptr;
+  size_ = 0;
+  owner_ = false;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/* RAII wrapper around a mapped POSIX shared-memory object (shm_open + mmap).
+   The creating side owns the name and unlinks it on destruction; attached
+   sides only unmap. Errors throw std::runtime_error. */
+class SharedMemory {
+public:
+  SharedMemory() = default;
+  ~SharedMemory();
+
+  SharedMemory(SharedMemory&& other) noexcept;
+  SharedMemory& operator=(SharedMemory&& other) noexcept;
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  /* Creates a new zero-filled object; fails if `name` already exists. */
+  static SharedMemory create(const std::string& name, std::size_t size);
+  static SharedMemory attach(const std::string& name, bool writable);
+
+  void* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  const std::string& name() const { return name_; }
+
+private:
+  void release();
+
+  std::string name_;
+  void* data_ = nullptr;
+  std::size_t size_ = 0;
+  bool owner_ = false;
+};
@@ -0,0 +1,136 @@
+#include "shared_model.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "activation.hpp"
+
+namespace {
+
+/* Shared-memory layout:
+     Header | uint32_t layer_sizes[num_layers] | activation name bytes
+     then, each starting on a 64-byte boundary, weights[0..L) and biases[0..L)
+     as row-major float matrices. */
+struct Header {
+  char magic[4];
+  uint32_t num_layers;
+  uint32_t activation_len;
+  uint32_t reserved;
+};
+
+constexpr std::size_t kAlignment = 64;
+
+std::size_t alignUp(std::size_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+std::size_t metadataSize(std::size_t num_layers, std::size_t activation_len) {
+  return alignUp(sizeof(Header) + num_layers * sizeof(uint32_t) + activation_len);
+}
+
+std::size_t matrixBytes(int rows, int cols) {
+  return alignUp(static_cast<std::size_t>(rows) * cols * sizeof(float));
+}
+
+}  // namespace
+
+SharedModel SharedModel::publish(const std::string& name, const NeuralNet<float>& net) {
+  const std::vector<int>& sizes = net.layerSizes();
+  const std::string& activation = net.activationName();
+  if (sizes.size() < 2 || net.weights().size() != sizes.size() - 1) {
+    throw std::runtime_error("Cannot publish a network that has not been built or loaded.");
+  }
+
+  std::size_t total = metadataSize(sizes.size(), activation.size());
+  for (std::size_t i = 0; i + 1 < sizes.size(); ++i) {
+    total += matrixBytes(sizes[i + 1], sizes[i]) + matrixBytes(sizes[i + 1], 1);
+  }
+
+  SharedModel model;
+  model.memory_ = SharedMemory::create(name, total);
+  char* base = static_cast<char*>(model.memory_.data());
+
+  Header header{{'N', 'N', 'S', 'M'}, static_cast<uint32_t>(sizes.size()),
+                static_cast<uint32_t>(activation.size()), 0};
+  std::memcpy(base, &header, sizeof(header));
+  char* cursor = base + sizeof(header);
+  for (int size : sizes) {
+    uint32_t value = static_cast<uint32_t>(size);
+    std::memcpy(cursor, &value, sizeof(value));
+    cursor += sizeof(value);
+  }
+  std::memcpy(cursor, activation.data(), activation.size());
+
+  char* data = base + metadataSize(sizes.size(), activation.size());
+  for (const auto* group : {&net.weights(), &net.biases()}) {
+    for (const Matrix<float>& matrix : *group) {
+      std::memcpy(data, matrix.data(), sizeof(float) * matrix.rows() * matrix.cols());
+      data += matrixBytes(matrix.rows(), matrix.cols());
+    }
+  }
+
+  model.mapLayout();
+  return model;
+}
+
+SharedModel SharedModel::attach(const std::string& name) {
+  SharedModel model;
+  model.memory_ = SharedMemory::attach(name, false);
+  model.mapLayout();
+  return model;
+}
+
+void SharedModel::mapLayout() {
+  const char* base = static_cast<const char*>(memory_.data());
+  if (memory_.size() < sizeof(Header)) {
+    throw std::runtime_error("Shared model is truncated.");
+  }
+
+  Header header;
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, "NNSM", 4) != 0 || header.num_layers < 2) {
+    throw std::runtime_error("Wrong shared model format.");
+  }
+
+  const char* cursor = base + sizeof(header);
+  layer_sizes_.clear();
+  for (uint32_t i = 0; i < header.num_layers; ++i) {
+    uint32_t value;
+    std::memcpy(&value, cursor, sizeof(value));
+    layer_sizes_.push_back(static_cast<int>(value));
+    cursor += sizeof(value);
+  }
+  activation_name_.assign(cursor, header.activation_len);
+  activation_ = activation::function<float>(activation::fromString(activation_name_));
+
+  std::size_t layers = layer_sizes_.size() - 1;
+  std::size_t offset = metadataSize(header.num_layers, header.activation_len);
+  auto next = [&](int rows, int cols) {
+    std::size_t bytes = matrixBytes(rows, cols);
+    if (offset + bytes > memory_.size()) {
+      throw std::runtime_error("Shared model is truncated.");
+    }
+    MatrixView<const float> view(reinterpret_cast<const float*>(base + offset), rows, cols);
+    offset += bytes;
+    return view;
+  };
+
+  weights_.clear();
+  biases_.clear();
+  for (std::size_t i = 0; i < layers; ++i) {
+    weights_.push_back(next(layer_sizes_[i + 1], layer_sizes_[i]));
+  }
+  for (std::size_t i = 0; i < layers; ++i) {
+    biases_.push_back(next(layer_sizes_[i + 1], 1));
+  }
+}
+
+void SharedModel::predictInto(MatrixView<const float> input, MatrixView<float> output) const {
+  Matrix<float> result = forwardLayers<float>(weights_, biases_, activation_, input);
+
+  for (int r = 0; r < output.rows(); ++r) {
+    for (int c = 0; c < output.cols(); ++c) {
+      output(r, c) = result.get(r, c);
+    }
+  }
+}
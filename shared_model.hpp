@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "matrix.hpp"
+#include "neuralnetwork.hpp"
+#include "shared_memory.hpp"
+
+/* Read-only copy of a trained network's parameters in POSIX shared memory.
+
+   publish() lays the topology, activation name and every weight and bias
+   matrix out in one shared-memory object (each matrix 64-byte aligned), so any
+   number of processes can attach() to it and run inference against the same
+   physical pages instead of each loading its own copy. Weights are exposed as
+   MatrixViews straight into the mapping. */
+class SharedModel {
+public:
+  static SharedModel publish(const std::string& name, const NeuralNet<float>& net);
+  static SharedModel attach(const std::string& name);
+
+  const std::vector<int>& layerSizes() const { return layer_sizes_; }
+  int inputSize() const { return layer_sizes_.front(); }
+  int outputSize() const { return layer_sizes_.back(); }
+  const std::string& activationName() const { return activation_name_; }
+  const std::string& name() const { return memory_.name(); }
+
+  MatrixView<const float> weights(std::size_t layer) const { return weights_[layer]; }
+  MatrixView<const float> biases(std::size_t layer) const { return biases_[layer]; }
+
+  /* Same computation as NeuralNet::predict() for a features x batch input,
+     written into a caller-provided outputs x batch view. */
+  void predictInto(MatrixView<const float> input, MatrixView<float> output) const;
+
+private:
+  void mapLayout();
+
+  SharedMemory memory_;
+  std::vector<int> layer_sizes_;
+  std::string activation_name_;
+  std::function<float(float)> activation_;
+  std::vector<MatrixView<const float>> weights_;
+  std::vector<MatrixView<const float>> biases_;
+};
@@ -0,0 +1,274 @@
+#include "socket_io.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace socket_io {
+
+namespace {
+
+[[noreturn]] void fail(const std::string& what) {
+  throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+sockaddr_un unixAddress(const std::string& path) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    throw std::runtime_error("Socket path too long: " + path);
+  }
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return addr;
+}
+
+/* Resolves host:port to an IPv4/IPv6 stream address (first match). */
+addrinfo* resolve(const std::string& host, int port, bool passive) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = passive ? AI_PASSIVE : 0;
+  addrinfo* result = nullptr;
+  std::string service = std::to_string(port);
+  int rc = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &result);
+  if (rc != 0) {
+    throw std::runtime_error("getaddrinfo(" + host + "): " + ::gai_strerror(rc));
+  }
+  return result;
+}
+
+void setNoDelay(int fd) {
+  int one = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+struct Endpoint {
+  bool tcp;
+  std::string path_or_host;
+  int port;
+};
+
+Endpoint parseEndpoint(const std::string& endpoint) {
+  if (endpoint.rfind("unix:", 0) == 0) {
+    return Endpoint{false, endpoint.substr(5), 0};
+  }
+  if (endpoint.rfind("tcp:", 0) == 0) {
+    std::size_t colon = endpoint.rfind(':');
+    if (colon > 4) {
+      try {
+        return Endpoint{true, endpoint.substr(4, colon - 4), std::stoi(endpoint.substr(colon + 1))};
+      } catch (const std::exception&) {
+      }
+    }
+  }
+  throw std::runtime_error("Bad endpoint '" + endpoint + "' (expected unix:<path> or tcp:<host>:<port>)");
+}
+
+}  // namespace
+
+int listenUnix(const std::string& path, int backlog) {
+  sockaddr_un addr = unixAddress(path);
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    fail("socket()");
+  }
+
+  ::unlink(path.c_str());
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    ::close(fd);
+    fail("bind(" + path + ")");
+  }
+  if (::listen(fd, backlog) < 0) {
+    ::close(fd);
+    fail("listen(" + path + ")");
+  }
+  return fd;
+}
+
+int connectUnix(const std::string& path) {
+  sockaddr_un addr = unixAddress(path);
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    fail("socket()");
+  }
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    ::close(fd);
+    fail("connect(" + path + ")");
+  }
+  return fd;
+}
+
+int listenTcp(const std::string& host, int port, int backlog) {
+  addrinfo* info = resolve(host, port, true);
+  int fd = ::socket(info->ai_family, info->ai_socktype | SOCK_CLOEXEC, info->ai_protocol);
+  if (fd < 0) {
+    ::freeaddrinfo(info);
+    fail("socket()");
+  }
+
+  int one = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  if (::bind(fd, info->ai_addr, info->ai_addrlen) < 0) {
+    ::freeaddrinfo(info);
+    ::close(fd);
+    fail("bind(" + host + ":" + std::to_string(port) + ")");
+  }
+  ::freeaddrinfo(info);
+  if (::listen(fd, backlog) < 0) {
+    ::close(fd);
+    fail("listen(" + host + ":" + std::to_string(port) + ")");
+  }
+  return fd;
+}
+
+int connectTcp(const std::string& host, int port) {
+  addrinfo* info = resolve(host, port, false);
+  int fd = ::socket(info->ai_family, info->ai_socktype | SOCK_CLOEXEC, info->ai_protocol);
+  if (fd < 0) {
+    ::freeaddrinfo(info);
+    fail("socket()");
+  }
+  if (::connect(fd, info->ai_addr, info->ai_addrlen) < 0) {
+    ::freeaddrinfo(info);
+    ::close(fd);
+    fail("connect(" + host + ":" + std::to_string(port) + ")");
+  }
+  ::freeaddrinfo(info);
+  setNoDelay(fd);
+  return fd;
+}
+
+int listenEndpoint(const std::string& endpoint, int backlog) {
+  Endpoint e = parseEndpoint(endpoint);
+  return e.tcp ? listenTcp(e.path_or_host, e.port, backlog) : listenUnix(e.path_or_host, backlog);
+}
+
+int connectEndpoint(const std::string& endpoint, int timeout_ms) {
+  Endpoint e = parseEndpoint(endpoint);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  for (;;) {
+    try {
+      return e.tcp ? connectTcp(e.path_or_host, e.port) : connectUnix(e.path_or_host);
+    } catch (const std::runtime_error&) {
+      /* Listener not up yet (ENOENT / ECONNREFUSED): retry until the deadline. */
+      if (std::chrono::steady_clock::now() >= deadline) throw;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+}
+
+int acceptConnection(int listen_fd) {
+  for (;;) {
+    int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd >= 0) {
+      sockaddr_storage addr{};
+      socklen_t len = sizeof(addr);
+      if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) == 0 && addr.ss_family != AF_UNIX) {
+        setNoDelay(fd);
+      }
+      return fd;
+    }
+    if (errno != EINTR) {
+      fail("accept()");
+    }
+  }
+}
+
+void removeEndpoint(const std::string& endpoint) {
+  Endpoint e = parseEndpoint(endpoint);
+  if (!e.tcp) {
+    ::unlink(e.path_or_host.c_str());
+  }
+}
+
+void sendAll(int fd, const void* data, std::size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR) continue;
+      fail("send()");
+    }
+    bytes += sent;
+    size -= static_cast<std::size_t>(sent);
+  }
+}
+
+bool recvAll(int fd, void* data, std::size_t size) {
+  char* bytes = static_cast<char*>(data);
+  std::size_t received = 0;
+  while (received < size) {
+    ssize_t n = ::recv(fd, bytes + received, size - received, 0);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      fail("recv()");
+    }
+    if (n == 0) {
+      if (received == 0) return false;
+      throw std::runtime_error("recv(): connection closed mid-message");
+    }
+    received += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+void sendRecv(int send_fd, const void* send_data, std::size_t send_size,
+              int recv_fd, void* recv_data, std::size_t recv_size) {
+  const char* out = static_cast<const char*>(send_data);
+  char* in = static_cast<char*>(recv_data);
+
+  while (send_size > 0 || recv_size > 0) {
+    pollfd fds[2];
+    nfds_t count = 0;
+    if (send_size > 0) fds[count++] = pollfd{send_fd, POLLOUT, 0};
+    if (recv_size > 0) fds[count++] = pollfd{recv_fd, POLLIN, 0};
+    if (::poll(fds, count, -1) < 0) {
+      if (errno == EINTR) continue;
+      fail("poll()");
+    }
+
+    for (nfds_t i = 0; i < count; ++i) {
+      if (fds[i].revents == 0) continue;
+      if (fds[i].events == POLLOUT) {
+        ssize_t n = ::send(send_fd, out, send_size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+          if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+          fail("send()");
+        }
+        out += n;
+        send_size -= static_cast<std::size_t>(n);
+      } else {
+        ssize_t n = ::recv(recv_fd, in, recv_size, MSG_DONTWAIT);
+        if (n < 0) {
+          if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+          fail("recv()");
+        }
+        if (n == 0) {
+          throw std::runtime_error("recv(): connection closed mid-message");
+        }
+        in += n;
+        recv_size -= static_cast<std::size_t>(n);
+      }
+    }
+  }
+}
+
+void closeFd(int fd) {
+  if (fd >= 0) {
+    ::close(fd);
+  }
+}
+
+}  // namespace socket_io
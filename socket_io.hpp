@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/* Thin blocking helpers over Unix-domain and TCP stream sockets. All
+   functions throw std::runtime_error (with errno text) on failure. */
+namespace socket_io {
+
+/* Binds and listens on `path`, replacing a stale socket file if present. */
+int listenUnix(const std::string& path, int backlog = 64);
+int connectUnix(const std::string& path);
+
+/* TCP with Nagle disabled (messages here are request/response sized).
+   listenTcp reuses the address so restarted jobs can rebind at once. */
+int listenTcp(const std::string& host, int port, int backlog = 64);
+int connectTcp(const std::string& host, int port);
+
+/* Endpoints are "unix:<path>" or "tcp:<host>:<port>". connectEndpoint retries
+   for up to timeout_ms while the listener is not there yet, so processes of
+   one job can be started in any order. */
+int listenEndpoint(const std::string& endpoint, int backlog = 64);
+int connectEndpoint(const std::string& endpoint, int timeout_ms = 10000);
+int acceptConnection(int listen_fd);
+
+/* Deletes the socket file of a "unix:" endpoint once its listener is
+   closed; does nothing for TCP. */
+void removeEndpoint(const std::string& endpoint);
+
+/* Loop until every byte is transferred. recvAll returns false if the peer
+   closed the connection before the first byte, and throws on a short read. */
+void sendAll(int fd, const void* data, std::size_t size);
+bool recvAll(int fd, void* data, std::size_t size);
+
+/* Sends one buffer on send_fd while receiving another on recv_fd, so peers
+   in a ring that all send before they read cannot deadlock on full socket
+   buffers. Throws if recv_fd closes early. */
+void sendRecv(int send_fd, const void* send_data, std::size_t send_size,
+              int recv_fd, void* recv_data, std::size_t recv_size);
+
+void closeFd(int fd);
+
+}  // namespace socket_io
@@ -0,0 +1,426 @@
+#include "sweep.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/mman.h>
+
+#include "evaluation.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+
+namespace sweep {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string joinSizes(const std::vector<int>& sizes) {
+  if (sizes.empty()) return "-";
+  std::ostringstream out;
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    out << (i ? "-" : "") << sizes[i];
+  }
+  return out.str();
+}
+
+/* Diverged trials (NaN or infinite loss) rank behind every finite one. */
+bool betterLoss(double a, double b) {
+  if (std::isfinite(a) != std::isfinite(b)) return std::isfinite(a);
+  return a < b;
+}
+
+struct TrialState {
+  NeuralNet<float> net;
+  Result result;
+};
+
+/* Batch-averaged gradients of one trial, with the batch columns split over
+   `threads` threads: the caller plus threads - 1 helpers started once and
+   kept for the team's lifetime, so a trial does not spawn threads for every
+   mini-batch. Parts are combined in column order, weighted by their size. */
+class GradientTeam {
+public:
+  GradientTeam(const NeuralNet<float>& net, int threads);
+  ~GradientTeam();
+
+  GradientTeam(const GradientTeam&) = delete;
+  GradientTeam& operator=(const GradientTeam&) = delete;
+
+  std::vector<float> gradient(MatrixView<const float> input, MatrixView<const float> target);
+
+private:
+  int partBegin(int part) const { return static_cast<int>(static_cast<long>(input_.cols()) * part / parts_); }
+  void computePart(int part);
+  void helperLoop(int part);
+  void shutdown();
+
+  const NeuralNet<float>& net_;
+  int threads_;
+  std::vector<std::thread> helpers_;
+  std::vector<std::vector<float>> partials_;
+
+  /* One batch at a time: gradient() publishes it under mutex_, bumps
+     generation_ and waits until every helper has finished its part. */
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  unsigned long generation_ = 0;
+  int pending_ = 0;
+  bool shutdown_ = false;
+  int parts_ = 0;
+  MatrixView<const float> input_{nullptr, 0, 0};
+  MatrixView<const float> target_{nullptr, 0, 0};
+  std::exception_ptr error_;
+};
+
+GradientTeam::GradientTeam(const NeuralNet<float>& net, int threads)
+  : net_(net), threads_(std::max(threads, 1)), partials_(threads_) {
+  try {
+    for (int part = 1; part < threads_; ++part) {
+      helpers_.emplace_back(&GradientTeam::helperLoop, this, part);
+    }
+  } catch (...) {
+    shutdown();
+    throw;
+  }
+}
+
+GradientTeam::~GradientTeam() {
+  shutdown();
+}
+
+void GradientTeam::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  start_cv_.notify_all();
+  for (std::thread& helper : helpers_) {
+    helper.join();
+  }
+  helpers_.clear();
+}
+
+void GradientTeam::computePart(int part) {
+  if (part >= parts_) return;
+  const int begin = partBegin(part);
+  const int size = partBegin(part + 1) - begin;
+  partials_[part] = net_.gradients(input_.block(0, begin, input_.rows(), size),
+                                   target_.block(0, begin, target_.rows(), size));
+}
+
+void GradientTeam::helperLoop(int part) {
+  parallel::Region region;  // the trial's share of threads is fixed
+  unsigned long seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&] { return shutdown_ || generation_ != seen; });
+      if (shutdown_) return;
+      seen = generation_;
+    }
+
+    try {
+      computePart(part);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) error_ = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+std::vector<float> GradientTeam::gradient(MatrixView<const float> input, MatrixView<const float> target) {
+  const int count = input.cols();
+  if (threads_ == 1 || count <= 1) {
+    return net_.gradients(input, target);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    input_ = input;
+    target_ = target;
+    parts_ = std::min(threads_, count);
+    error_ = nullptr;
+    pending_ = static_cast<int>(helpers_.size());
+    ++generation_;
+  }
+  start_cv_.notify_all();
+
+  std::exception_ptr error;
+  try {
+    parallel::Region region;
+    computePart(0);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return pending_ == 0; });
+    if (!error) error = error_;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  std::vector<float> gradient(partials_[0].size(), 0.0f);
+  for (int p = 0; p < parts_; ++p) {
+    const float weight = static_cast<float>(partBegin(p + 1) - partBegin(p)) / count;
+    for (std::size_t i = 0; i < gradient.size(); ++i) {
+      gradient[i] += weight * partials_[p][i];
+    }
+  }
+  return gradient;
+}
+
+void trainTo(TrialState& state, const SharedDataset& data, int epochs, const Options& options) {
+  MatrixView<const float> inputs = data.trainInputs();
+  MatrixView<const float> targets = data.trainTargets();
+  const int samples = inputs.cols();
+  const int batch = std::max(options.batch_size, 1);
+  GradientTeam team(state.net, options.threads_per_trial);
+
+  for (; state.result.epochs < epochs; ++state.result.epochs) {
+    for (int first = 0; first < samples; first += batch) {
+      const int count = std::min(batch, samples - first);
+      std::vector<float> gradient = team.gradient(inputs.block(0, first, inputs.rows(), count),
+                                                  targets.block(0, first, targets.rows(), count));
+      state.net.applyGradients(gradient, state.result.trial.learning_rate);
+    }
+  }
+}
+
+/* Runs fn(index) for every index in [0, count) on up to `slots` threads,
+   each taking the next index as soon as it is free, since trials differ
+   in cost. The first exception is rethrown once all threads stop. */
+template<typename Fn>
+void forEachDynamic(std::size_t count, int slots, Fn&& fn) {
+  std::atomic<std::size_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto work = [&]() {
+    parallel::Region region;  // trials get exactly threads_per_trial threads
+    for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+      try {
+        fn(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+        next.store(count);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  const std::size_t extra = std::min<std::size_t>(count, static_cast<std::size_t>(std::max(slots, 1))) - 1;
+  for (std::size_t t = 0; t < extra; ++t) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace
+
+std::string Trial::describe() const {
+  std::ostringstream out;
+  out << joinSizes(hidden) << " " << activation << " " << initializer << " lr=" << learning_rate;
+  return out.str();
+}
+
+std::vector<Trial> Space::grid() const {
+  std::vector<Trial> trials;
+  for (const std::vector<int>& layers : hidden) {
+    for (const std::string& activation : activations) {
+      for (const std::string& initializer : initializers) {
+        for (float learning_rate : learning_rates) {
+          trials.push_back(Trial{layers, activation, initializer, learning_rate});
+        }
+      }
+    }
+  }
+  return trials;
+}
+
+/* SharedDataset */
+
+SharedDataset::SharedDataset(const Dataset& data, double validation_fraction, uint64_t seed) {
+  const std::size_t samples = data.size();
+  if (samples < 2) {
+    throw std::runtime_error("A sweep needs at least two samples.");
+  }
+  std::size_t validation = static_cast<std::size_t>(std::lround(samples * validation_fraction));
+  validation = std::min(std::max<std::size_t>(validation, 1), samples - 1);
+  const std::size_t train = samples - validation;
+
+  /* Fisher-Yates with Philox draws, so the split depends only on the seed. */
+  std::vector<std::size_t> order(samples);
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  const rng::Stream stream{seed, 0};
+  for (std::size_t i = samples - 1; i > 0; --i) {
+    std::size_t j = stream.block(i)[0] % (i + 1);
+    std::swap(order[i], order[j]);
+  }
+
+  const int features = data.inputs.rows();
+  const int classes = data.targets.rows();
+  bytes_ = sizeof(float) * samples * static_cast<std::size_t>(features + classes);
+  base_ = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base_ == MAP_FAILED) {
+    base_ = nullptr;
+    throw std::runtime_error("mmap() for the sweep dataset failed.");
+  }
+
+  float* cursor = static_cast<float*>(base_);
+  auto place = [&](const Matrix<float>& source, std::size_t first, std::size_t count) {
+    MatrixView<float> view(cursor, source.rows(), static_cast<int>(count));
+    for (int r = 0; r < source.rows(); ++r) {
+      for (std::size_t c = 0; c < count; ++c) {
+        view(r, static_cast<int>(c)) = source.get(r, static_cast<int>(order[first + c]));
+      }
+    }
+    cursor += static_cast<std::size_t>(source.rows()) * count;
+    return MatrixView<const float>(view);
+  };
+  train_inputs_ = place(data.inputs, 0, train);
+  train_targets_ = place(data.targets, 0, train);
+  validation_inputs_ = place(data.inputs, train, validation);
+  validation_targets_ = place(data.targets, train, validation);
+
+  ::mprotect(base_, bytes_, PROT_READ);
+}
+
+SharedDataset::~SharedDataset() {
+  if (base_) {
+    ::munmap(base_, bytes_);
+  }
+}
+
+/* Report */
+
+void Report::writeTable(std::ostream& out) const {
+  std::vector<std::size_t> order(results.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    if (a == best || b == best) return a == best && b != best;
+    if (results[a].rung != results[b].rung) return results[a].rung > results[b].rung;
+    return betterLoss(results[a].validation_loss, results[b].validation_loss);
+  });
+
+  out << "rank\ttrial\thidden\tactivation\tinitializer\tlearning_rate\tepochs\trung\tstatus"
+         "\tvalidation_loss\tvalidation_accuracy\tseconds\n";
+  for (std::size_t rank = 0; rank < order.size(); ++rank) {
+    const Result& r = results[order[rank]];
+    out << rank + 1 << "\t" << order[rank] << "\t" << joinSizes(r.trial.hidden) << "\t" << r.trial.activation
+        << "\t" << r.trial.initializer << "\t" << r.trial.learning_rate << "\t" << r.epochs << "\t" << r.rung
+        << "\t" << (r.finished ? "finished" : "pruned") << "\t" << std::setprecision(6) << r.validation_loss
+        << "\t" << r.validation_accuracy << "\t" << std::setprecision(4) << r.seconds << "\n";
+  }
+}
+
+/* run */
+
+Report run(const SharedDataset& data, const std::vector<Trial>& trials, const Options& options) {
+  if (trials.empty()) {
+    throw std::runtime_error("Sweep has no trials.");
+  }
+  if (options.min_epochs < 1 || options.max_epochs < options.min_epochs || options.eta < 2) {
+    throw std::runtime_error("Sweep needs 1 <= min_epochs <= max_epochs and eta >= 2.");
+  }
+  const int per_trial = std::max(options.threads_per_trial, 1);
+  const int slots = std::max(parallel::resolveThreads(options.threads) / per_trial, 1);
+  auto start = Clock::now();
+
+  std::vector<TrialState> states(trials.size());
+  for (std::size_t i = 0; i < trials.size(); ++i) {
+    const Trial& trial = trials[i];
+    std::vector<int> layers{data.features()};
+    layers.insert(layers.end(), trial.hidden.begin(), trial.hidden.end());
+    layers.push_back(data.classes());
+
+    NeuralNet<float>& net = states[i].net;
+    net.setLayerSizes(layers);
+    net.setActivation(trial.activation);
+    net.pickInitializer(trial.initializer);
+    net.setSeed(options.seed + i);
+    net.setThreads(1);
+    net.setVerbose(false);
+    net.build();
+    states[i].result.trial = trial;
+  }
+
+  evaluation::Options eval_options;
+  eval_options.threads = per_trial;
+
+  std::vector<std::size_t> active(trials.size());
+  std::iota(active.begin(), active.end(), std::size_t{0});
+  int rung = 0;
+  long budget = options.min_epochs;
+  for (;;) {
+    const int epochs = static_cast<int>(std::min<long>(budget, options.max_epochs));
+    forEachDynamic(active.size(), slots, [&](std::size_t a) {
+      TrialState& state = states[active[a]];
+      auto trial_start = Clock::now();
+      trainTo(state, data, epochs, options);
+      evaluation::Report report =
+          evaluation::evaluate(state.net, data.validationInputs(), data.validationTargets(), eval_options);
+      state.result.rung = rung;
+      state.result.validation_loss = report.loss();
+      state.result.validation_accuracy = report.accuracy();
+      state.result.seconds += secondsSince(trial_start);
+    });
+
+    std::stable_sort(active.begin(), active.end(), [&](std::size_t a, std::size_t b) {
+      return betterLoss(states[a].result.validation_loss, states[b].result.validation_loss);
+    });
+    if (epochs >= options.max_epochs) {
+      for (std::size_t index : active) states[index].result.finished = true;
+      break;
+    }
+
+    const std::size_t keep = (active.size() + options.eta - 1) / options.eta;
+    active.resize(std::max<std::size_t>(keep, 1));
+    /* A lone survivor has nothing left to be compared against. */
+    budget = active.size() == 1 ? options.max_epochs : budget * options.eta;
+    ++rung;
+  }
+
+  Report report;
+  report.rungs = rung + 1;
+  report.best = active.front();
+  report.best_model = states[report.best].net;
+  for (TrialState& state : states) {
+    report.epochs += static_cast<std::size_t>(state.result.epochs);
+    report.results.push_back(std::move(state.result));
+  }
+  report.seconds = secondsSince(start);
+  return report;
+}
+
+}  // namespace sweep
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "loader.hpp"
+#include "matrix.hpp"
+#include "neuralnetwork.hpp"
+
+/* Parallel hyperparameter sweeps with successive halving.
+
+   The dataset is copied once into a read-only mapping (SharedDataset) that
+   every trial reads through views, instead of each run re-parsing the file.
+   run() trains many configurations at once: trials are handed to
+   threads / threads_per_trial worker slots, and each trial uses exactly
+   threads_per_trial threads for its gradients and evaluation.
+
+   Successive halving: all trials train for min_epochs, are scored on the
+   validation split, and only the best 1/eta go on to eta times as many
+   epochs, until the survivors reach max_epochs. Trials keep their weights
+   between rungs, so promotion continues training rather than restarting. */
+namespace sweep {
+
+struct Trial {
+  std::vector<int> hidden;  // hidden layer sizes; input/output come from the data
+  std::string activation;
+  std::string initializer;
+  float learning_rate = 0.1f;
+
+  std::string describe() const;  // e.g. "8-8 ReLU He lr=0.05"
+};
+
+/* Grid of values to sweep; grid() is the cartesian product. */
+struct Space {
+  std::vector<std::vector<int>> hidden;
+  std::vector<std::string> activations;
+  std::vector<std::string> initializers;
+  std::vector<float> learning_rates;
+
+  std::vector<Trial> grid() const;
+};
+
+struct Options {
+  int threads = 0;            // total worker threads; <= 0 uses every core
+  int threads_per_trial = 1;  // fixed share of every running trial
+  int min_epochs = 10;        // budget of the first rung
+  int max_epochs = 1000;      // budget of the last rung
+  int eta = 3;                // keep the best 1/eta of each rung
+  int batch_size = 8;
+  double validation_fraction = 0.2;
+  uint64_t seed = 1;          // split shuffle and per-trial weight seeds
+};
+
+/* A dataset shuffled and split into training and validation columns, held
+   in one page-aligned mapping that is write-protected once filled. All
+   trials share it; a stray write faults instead of corrupting a sweep. */
+class SharedDataset {
+public:
+  SharedDataset(const Dataset& data, double validation_fraction, uint64_t seed);
+  ~SharedDataset();
+
+  SharedDataset(const SharedDataset&) = delete;
+  SharedDataset& operator=(const SharedDataset&) = delete;
+
+  MatrixView<const float> trainInputs() const { return train_inputs_; }
+  MatrixView<const float> trainTargets() const { return train_targets_; }
+  MatrixView<const float> validationInputs() const { return validation_inputs_; }
+  MatrixView<const float> validationTargets() const { return validation_targets_; }
+
+  int features() const { return train_inputs_.rows(); }
+  int classes() const { return train_targets_.rows(); }
+  std::size_t bytes() const { return bytes_; }
+
+private:
+  void* base_ = nullptr;
+  std::size_t bytes_ = 0;
+  MatrixView<const float> train_inputs_{nullptr, 0, 0};
+  MatrixView<const float> train_targets_{nullptr, 0, 0};
+  MatrixView<const float> validation_inputs_{nullptr, 0, 0};
+  MatrixView<const float> validation_targets_{nullptr, 0, 0};
+};
+
+struct Result {
+  Trial trial;
+  int epochs = 0;                 // epochs trained before finishing or being pruned
+  int rung = 0;                   // last rung the trial took part in
+  bool finished = false;          // survived to max_epochs
+  double validation_loss = 0.0;   // at the last rung
+  double validation_accuracy = 0.0;
+  double seconds = 0.0;           // training + evaluation time of this trial
+};
+
+struct Report {
+  std::vector<Result> results;  // in trial order
+  std::size_t best = 0;         // index into results
+  int rungs = 0;
+  double seconds = 0.0;         // wall time of the whole sweep
+  std::size_t epochs = 0;       // epochs trained across all trials
+  NeuralNet<float> best_model;
+
+  /* Tab-separated table, best first, then by rung reached and loss. */
+  void writeTable(std::ostream& out) const;
+};
+
+/* Runs the sweep. Trials are seeded with options.seed + their index, so a
+   sweep is reproducible for a fixed threads_per_trial (the split of each
+   batch across threads changes the rounding of the summed gradient). */
+Report run(const SharedDataset& data, const std::vector<Trial>& trials, const Options& options);
+
+}  // namespace sweep